@@ -0,0 +1,133 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "renderbatch.h"
+#include "src/tools/annotationrenderer.h"
+#include <QElapsedTimer>
+#include <QFileDevice>
+#include <QImageReader>
+#include <QImageWriter>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <utility>
+
+class RenderJob : public QRunnable
+{
+public:
+    RenderJob(RenderBatch* batch, QByteArray line)
+      : m_batch(batch)
+      , m_line(std::move(line))
+    {}
+
+    void run() override
+    {
+        QJsonObject result = render();
+        m_batch->report(result);
+        m_batch->m_slots.release();
+    }
+
+private:
+    QJsonObject render()
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        QJsonParseError parseError;
+        QJsonObject job = QJsonDocument::fromJson(m_line, &parseError).object();
+        QJsonObject result;
+        if (job.contains(QStringLiteral("id"))) {
+            result["id"] = job.value(QStringLiteral("id"));
+        }
+        if (parseError.error != QJsonParseError::NoError) {
+            return failure(result, parseError.errorString());
+        }
+
+        QString input = job.value(QStringLiteral("input")).toString();
+        QString output = job.value(QStringLiteral("output")).toString();
+        if (input.isEmpty() || output.isEmpty()) {
+            return failure(result,
+                           QStringLiteral("input and output are required"));
+        }
+        result["output"] = output;
+
+        QVector<AnnotationRenderer::Annotation> annotations;
+        QString error;
+        if (!AnnotationRenderer::parse(
+              job.value(QStringLiteral("annotations")).toArray(),
+              annotations,
+              error)) {
+            return failure(result, error);
+        }
+
+        QImageReader reader(input);
+        QImage image = reader.read();
+        if (image.isNull()) {
+            return failure(
+              result, QStringLiteral("%1: %2").arg(input, reader.errorString()));
+        }
+
+        image = AnnotationRenderer::render(image, annotations);
+
+        QImageWriter writer(output);
+        if (writer.format().isEmpty()) {
+            writer.setFormat("png");
+        }
+        if (!writer.write(image)) {
+            return failure(
+              result,
+              QStringLiteral("%1: %2").arg(output, writer.errorString()));
+        }
+        result["ok"] = true;
+        result["msecs"] = timer.elapsed();
+        return result;
+    }
+
+    static QJsonObject failure(QJsonObject result, const QString& error)
+    {
+        result["ok"] = false;
+        result["error"] = error;
+        return result;
+    }
+
+    RenderBatch* m_batch;
+    QByteArray m_line;
+};
+
+RenderBatch::RenderBatch(int jobs)
+  : m_slots(jobs * 2)
+{
+    m_pool.setMaxThreadCount(jobs);
+}
+
+bool RenderBatch::run(QIODevice& input, QIODevice& output)
+{
+    m_output = &output;
+    // readLine blocks until the producer writes a whole line and returns
+    // nothing at the end of the input
+    QByteArray line;
+    while (!(line = input.readLine()).isEmpty()) {
+        line = line.trimmed();
+        if (line.isEmpty()) {
+            continue;
+        }
+        m_slots.acquire();
+        m_pool.start(new RenderJob(this, line));
+    }
+    m_pool.waitForDone();
+    return !m_failed;
+}
+
+void RenderBatch::report(const QJsonObject& result)
+{
+    QMutexLocker locker(&m_outputMutex);
+    if (!result.value(QStringLiteral("ok")).toBool()) {
+        m_failed = true;
+    }
+    m_output->write(QJsonDocument(result).toJson(QJsonDocument::Compact) +
+                    '\n');
+    // Let a consumer of the pipe pick the result up right away
+    if (auto* file = qobject_cast<QFileDevice*>(m_output)) {
+        file->flush();
+    }
+}
@@ -0,0 +1,41 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QMutex>
+#include <QSemaphore>
+#include <QThreadPool>
+
+class QIODevice;
+class QJsonObject;
+
+// Runs the jobs of `flameshot render`. Every line of the input is a job
+//   {"input": "in.png", "output": "out.png", "annotations": [...]}
+// with the annotations of AnnotationRenderer::parse and an optional "id"
+// copied into the result. Jobs run in parallel and every finished job writes
+// one line to the output as soon as it is done, so the results are in the
+// order of completion:
+//   {"id": ..., "output": "out.png", "ok": true, "msecs": 12}
+//   {"id": ..., "ok": false, "error": "..."}
+class RenderBatch
+{
+public:
+    explicit RenderBatch(int jobs);
+
+    // Returns once all the jobs of `input` are done, false if any failed
+    bool run(QIODevice& input, QIODevice& output);
+
+private:
+    void report(const QJsonObject& result);
+
+    QThreadPool m_pool;
+    // Bounds the jobs read ahead of the workers, a long input is not loaded
+    // in memory at once
+    QSemaphore m_slots;
+    QMutex m_outputMutex;
+    QIODevice* m_output = nullptr;
+    bool m_failed = false;
+
+    friend class RenderJob;
+};
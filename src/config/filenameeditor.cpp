@@ -93,6 +93,7 @@ void FileNameEditor::savePattern()
 {
     QString pattern = m_nameEditor->text();
     ConfigHandler().setFilenamePattern(pattern);
+    FileNameHandler::invalidatePattern();
 }
 
 void FileNameEditor::showParsedPattern(const QString& p)
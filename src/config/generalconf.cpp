@@ -47,6 +47,7 @@ GeneralConf::GeneralConf(QWidget* parent)
     initShowHelp();
     initShowSidePanelButton();
     initUseJpgForClipboard();
+    initOptimizePng();
     initCopyOnDoubleClick();
     initEnterPin();
     initSaveAfterCopy();
@@ -66,6 +67,7 @@ GeneralConf::GeneralConf(QWidget* parent)
     initShowMagnifier();
     initSquareMagnifier();
     initJpegQuality();
+    initPinMemoryBudget();
     initDelayTakeScreenshotTime();
     // this has to be at the end
     initConfigButtons();
@@ -84,6 +86,10 @@ void GeneralConf::_updateComponents(bool allowEmptySavePath)
     m_copyPathAfterSave->setChecked(config.copyPathAfterSave());
     m_antialiasingPinZoom->setChecked(config.antialiasingPinZoom());
     m_useJpgForClipboard->setChecked(config.useJpgForClipboard());
+    m_optimizePngOnSave->setChecked(config.optimizePngOnSave());
+    m_optimizePngOnCopy->setChecked(config.optimizePngOnCopy());
+    m_optimizePngOnUpload->setChecked(config.optimizePngOnUpload());
+    m_optimizePngDither->setChecked(config.optimizePngDither());
     m_copyOnDoubleClick->setChecked(config.copyOnDoubleClick());
     m_enterKeyPin->setChecked(config.enterKeyPin());
     m_uploadWithoutConfirmation->setChecked(config.uploadWithoutConfirmation());
@@ -639,6 +645,45 @@ void GeneralConf::initUseJpgForClipboard()
             &GeneralConf::useJpgForClipboardChanged);
 }
 
+void GeneralConf::initOptimizePng()
+{
+    const QString tooltip =
+      tr("Images with few colors, like most screenshots of applications, "
+         "are written as much smaller 8-bit palette PNGs");
+    m_optimizePngOnSave =
+      new QCheckBox(tr("Reduce the colors of saved PNG images"), this);
+    m_optimizePngOnSave->setToolTip(tooltip);
+    m_scrollAreaLayout->addWidget(m_optimizePngOnSave);
+    connect(m_optimizePngOnSave, &QCheckBox::clicked, [](bool checked) {
+        ConfigHandler().setOptimizePngOnSave(checked);
+    });
+
+    m_optimizePngOnCopy =
+      new QCheckBox(tr("Reduce the colors of copied PNG images"), this);
+    m_optimizePngOnCopy->setToolTip(tooltip);
+    m_scrollAreaLayout->addWidget(m_optimizePngOnCopy);
+    connect(m_optimizePngOnCopy, &QCheckBox::clicked, [](bool checked) {
+        ConfigHandler().setOptimizePngOnCopy(checked);
+    });
+
+    m_optimizePngOnUpload =
+      new QCheckBox(tr("Reduce the colors of uploaded images"), this);
+    m_optimizePngOnUpload->setToolTip(tooltip);
+    m_scrollAreaLayout->addWidget(m_optimizePngOnUpload);
+    connect(m_optimizePngOnUpload, &QCheckBox::clicked, [](bool checked) {
+        ConfigHandler().setOptimizePngOnUpload(checked);
+    });
+
+    m_optimizePngDither =
+      new QCheckBox(tr("Dither the images with reduced colors"), this);
+    m_optimizePngDither->setToolTip(
+      tr("Smoother gradients at the cost of slightly bigger files"));
+    m_scrollAreaLayout->addWidget(m_optimizePngDither);
+    connect(m_optimizePngDither, &QCheckBox::clicked, [](bool checked) {
+        ConfigHandler().setOptimizePngDither(checked);
+    });
+}
+
 void GeneralConf::saveAfterCopyChanged(bool checked)
 {
     ConfigHandler().setSaveAfterCopy(checked);
@@ -814,6 +859,28 @@ void GeneralConf::initJpegQuality()
             &GeneralConf::setJpegQuality);
 }
 
+void GeneralConf::initPinMemoryBudget()
+{
+    auto* tobox = new QHBoxLayout();
+
+    int budget = ConfigHandler().value("pinMemoryBudget").toInt();
+    m_pinMemoryBudget = new QSpinBox();
+    m_pinMemoryBudget->setRange(0, 1024 * 1024);
+    m_pinMemoryBudget->setSuffix(QStringLiteral(" MiB"));
+    m_pinMemoryBudget->setToolTip(
+      tr("Least recently used pins only keep their displayed size in memory "
+         "above this limit, 0 means no limit"));
+    m_pinMemoryBudget->setValue(budget);
+    tobox->addWidget(m_pinMemoryBudget);
+    tobox->addWidget(new QLabel(tr("Pinned screenshots memory")));
+
+    m_scrollAreaLayout->addLayout(tobox);
+    connect(m_pinMemoryBudget,
+            static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged),
+            this,
+            &GeneralConf::setPinMemoryBudget);
+}
+
 void GeneralConf::initDelayTakeScreenshotTime()
 {
     auto* tobox = new QHBoxLayout();
@@ -843,6 +910,11 @@ void GeneralConf::setJpegQuality(int v)
     ConfigHandler().setJpegQuality(v);
 }
 
+void GeneralConf::setPinMemoryBudget(int v)
+{
+    ConfigHandler().setPinMemoryBudget(v);
+}
+
 void GeneralConf::setDelayTakeScreenshotTime(int v)
 {
     ConfigHandler().setDelayTakeScreenshotTime(v);
@@ -58,6 +58,7 @@ private slots:
     void setGeometryLocation(int index);
     void setSelGeoHideTime(int v);
     void setJpegQuality(int v);
+    void setPinMemoryBudget(int v);
     void setDelayTakeScreenshotTime(int v);
 
 private:
@@ -89,11 +90,13 @@ private:
     void initUndoLimit();
     void initUploadWithoutConfirmation();
     void initUseJpgForClipboard();
+    void initOptimizePng();
     void initUploadHistoryMax();
     void initUploadClientSecret();
     void initSaveLastRegion();
     void initShowSelectionGeometry();
     void initJpegQuality();
+    void initPinMemoryBudget();
     void initDelayTakeScreenshotTime();
 
     void _updateComponents(bool allowEmptySavePath);
@@ -128,6 +131,10 @@ private:
     QCheckBox* m_screenshotPathFixedCheck;
     QCheckBox* m_historyConfirmationToDelete;
     QCheckBox* m_useJpgForClipboard;
+    QCheckBox* m_optimizePngOnSave;
+    QCheckBox* m_optimizePngOnCopy;
+    QCheckBox* m_optimizePngOnUpload;
+    QCheckBox* m_optimizePngDither;
     QSpinBox* m_uploadHistoryMax;
     QSpinBox* m_undoLimit;
     QComboBox* m_setSaveAsFileExtension;
@@ -140,5 +147,6 @@ private:
     QComboBox* m_selectGeometryLocation;
     QSpinBox* m_xywhTimeout;
     QSpinBox* m_jpegQuality;
+    QSpinBox* m_pinMemoryBudget;
     QSpinBox* m_delayTakeScreenshotTime;
 };
@@ -7,9 +7,24 @@
 #include <QApplication>
 #include <QClipboard>
 #include <QDateTime>
+#include <atomic>
 #include <stdexcept>
 #include <utility>
 
+namespace {
+// Ids are unique within a process, they tie together the log records of a
+// capture
+uint nextId()
+{
+    static std::atomic<uint> lastId{ 0 };
+    return ++lastId;
+}
+}
+
+CaptureRequest::CaptureRequest()
+  : m_id(nextId())
+{}
+
 CaptureRequest::CaptureRequest(CaptureRequest::CaptureMode mode,
                                const uint delay,
                                QVariant data,
@@ -18,6 +33,7 @@ CaptureRequest::CaptureRequest(CaptureRequest::CaptureMode mode,
   , m_delay(delay)
   , m_tasks(tasks)
   , m_data(std::move(data))
+  , m_id(nextId())
 {
 
     ConfigHandler config;
@@ -27,6 +43,16 @@ CaptureRequest::CaptureRequest(CaptureRequest::CaptureMode mode,
     }
 }
 
+void CaptureRequest::setStaticID(uint id)
+{
+    m_id = id;
+}
+
+uint CaptureRequest::id() const
+{
+    return m_id;
+}
+
 CaptureRequest::CaptureMode CaptureRequest::captureMode() const
 {
     return m_mode;
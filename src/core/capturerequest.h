@@ -15,6 +15,8 @@ public:
         FULLSCREEN_MODE,
         GRAPHICAL_MODE,
         SCREEN_MODE,
+        SCROLL_MODE,
+        RECORD_MODE,
     };
 
     enum ExportTask
@@ -60,8 +62,9 @@ private:
     ExportTask m_tasks;
     QVariant m_data;
     QRect m_pinWindowGeometry, m_initialSelection;
+    uint m_id;
 
-    CaptureRequest() {}
+    CaptureRequest();
 };
 
 using eTask = CaptureRequest::ExportTask;
@@ -15,8 +15,12 @@
 #include "src/tools/imgupload/imguploadermanager.h"
 #include "src/tools/imgupload/storages/imguploaderbase.h"
 #include "src/utils/confighandler.h"
+#include "src/utils/metrics.h"
 #include "src/utils/screengrabber.h"
 #include "src/widgets/capture/capturewidget.h"
+#include "src/widgets/capture/recordwidget.h"
+#include "src/widgets/capture/scrollcapturewidget.h"
+#include "src/widgets/capture/selectorwidget.h"
 #include "src/widgets/capturelauncher.h"
 #include "src/widgets/imguploaddialog.h"
 #include "src/widgets/infowindow.h"
@@ -26,6 +30,7 @@
 #include <QDebug>
 #include <QDesktopServices>
 #include <QDesktopWidget>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QMessageBox>
 #include <QThread>
@@ -95,7 +100,7 @@ CaptureWidget* Flameshot::gui(const CaptureRequest& req)
     }
 #endif
 
-    if (nullptr == m_captureWindow) {
+    if (nullptr == m_captureWindow && nullptr == m_selectorWindow) {
         // TODO is this unnecessary now?
         int timeout = 5000; // 5 seconds
         const int delay = 100;
@@ -115,6 +120,14 @@ CaptureWidget* Flameshot::gui(const CaptureRequest& req)
             return nullptr;
         }
 
+        // Time from the request until the overlay is shown, grab included
+        Metrics::Timer timer(QStringLiteral("overlay"));
+        if (SelectorWidget::handles(req)) {
+            // Nothing can be drawn on this capture, skip the editor
+            m_selectorWindow = new SelectorWidget(req);
+            m_selectorWindow->showFullScreen();
+            return nullptr;
+        }
         m_captureWindow = new CaptureWidget(req);
 
 #ifdef Q_OS_WIN
@@ -155,7 +168,10 @@ void Flameshot::screen(CaptureRequest req, const int screenNumber)
     } else {
         screen = qApp->screens()[screenNumber];
     }
+    QElapsedTimer timer;
+    timer.start();
     QPixmap p(ScreenGrabber().grabScreen(screen, ok));
+    qint64 grabTime = timer.restart();
     if (ok) {
         QRect geometry = ScreenGrabber().screenGeometry(screen);
         QRect region = req.initialSelection();
@@ -171,7 +187,12 @@ void Flameshot::screen(CaptureRequest req, const int screenNumber)
             // change geometry for pin task
             req.addPinTask(region);
         }
-        exportCapture(p, geometry, req);
+        exportCapture(p, geometry, req, screen->geometry());
+        AbstractLogger::info(AbstractLogger::LogFile)
+          .attachCaptureId(req.id())
+          .addDuration("grab", grabTime)
+          .addDuration("export", timer.elapsed())
+          << QStringLiteral("Screen captured");
     } else {
         emit captureFailed();
     }
@@ -184,7 +205,10 @@ void Flameshot::full(const CaptureRequest& req)
     }
 
     bool ok = true;
+    QElapsedTimer timer;
+    timer.start();
     QPixmap p(ScreenGrabber().grabEntireDesktop(ok));
+    qint64 grabTime = timer.restart();
     QRect region = req.initialSelection();
     if (!region.isNull()) {
         p = p.copy(region);
@@ -192,11 +216,69 @@ void Flameshot::full(const CaptureRequest& req)
     if (ok) {
         QRect selection; // `flameshot full` does not support --selection
         exportCapture(p, selection, req);
+        AbstractLogger::info(AbstractLogger::LogFile)
+          .attachCaptureId(req.id())
+          .addDuration("grab", grabTime)
+          .addDuration("export", timer.elapsed())
+          << QStringLiteral("Desktop captured");
     } else {
         emit captureFailed();
     }
 }
 
+void Flameshot::scroll(const CaptureRequest& req)
+{
+    grabRegion(req, [req](const QRect& region) {
+        return new ScrollCaptureWidget(req, region);
+    });
+}
+
+void Flameshot::record(const CaptureRequest& req)
+{
+    const QVariantMap options = req.data().toMap();
+    const int fps = options.value(QStringLiteral("fps"), 10).toInt();
+    const int duration = options.value(QStringLiteral("duration"), 0).toInt();
+    grabRegion(req, [req, fps, duration](const QRect& region) {
+        return new RecordWidget(req, region, fps, duration);
+    });
+}
+
+/**
+ * @brief Starts the widget made by `start` on the initial selection of the
+ * request, or on a region selected by the user first.
+ */
+void Flameshot::grabRegion(
+  const CaptureRequest& req,
+  const std::function<RegionGrabWidget*(const QRect&)>& start)
+{
+    if (!resolveAnyConfigErrors()) {
+        return;
+    }
+    if (m_captureWindow || m_selectorWindow || m_regionGrabWindow) {
+        emit captureFailed();
+        return;
+    }
+
+    auto startGrab = [this, start](const QRect& region) {
+        m_regionGrabWindow = start(region);
+        m_regionGrabWindow->show();
+    };
+    QRect region = req.initialSelection();
+    if (!region.isNull()) {
+        // Like in the selector, the region is in the pixels of the desktop
+        // screenshot, from the top left corner of the desktop
+        const qreal scale = qApp->primaryScreen()->devicePixelRatio();
+        const QPoint origin = ScreenGrabber().desktopGeometry().topLeft();
+        region.translate(-origin);
+        region = QRect(region.topLeft() / scale, region.size() / scale);
+        startGrab(region.translated(origin));
+        return;
+    }
+    m_selectorWindow = new SelectorWidget(req);
+    connect(m_selectorWindow, &SelectorWidget::regionSelected, startGrab);
+    m_selectorWindow->showFullScreen();
+}
+
 void Flameshot::launcher()
 {
     if (!resolveAnyConfigErrors()) {
@@ -338,19 +420,33 @@ void Flameshot::requestCapture(const CaptureRequest& request)
               request.delay(), this, [this, request]() { gui(request); });
             break;
         }
+        case CaptureRequest::SCROLL_MODE: {
+            QTimer::singleShot(
+              request.delay(), this, [this, request]() { scroll(request); });
+            break;
+        }
+        case CaptureRequest::RECORD_MODE: {
+            QTimer::singleShot(
+              request.delay(), this, [this, request]() { record(request); });
+            break;
+        }
         default:
             emit captureFailed();
             break;
     }
 }
 
+// `logicalSelection` is the captured area in global logical coordinates,
+// when `selection` is in device pixels
 void Flameshot::exportCapture(const QPixmap& capture,
                               QRect& selection,
-                              const CaptureRequest& req)
+                              const CaptureRequest& req,
+                              const QRect& logicalSelection)
 {
     using CR = CaptureRequest;
     int tasks = req.tasks(), mode = req.captureMode();
     QString path = req.path();
+    Metrics::instance()->increment(QStringLiteral("captures"));
 
     if (tasks & CR::PRINT_GEOMETRY) {
         QByteArray byteArray;
@@ -375,7 +471,15 @@ void Flameshot::exportCapture(const QPixmap& capture,
         if (req.path().isEmpty()) {
             saveToFilesystemGUI(capture);
         } else {
-            saveToFilesystem(capture, path);
+            FilenameContext context;
+            context.captureId = req.id();
+            QRect area =
+              logicalSelection.isNull() ? selection : logicalSelection;
+            if (!area.isNull()) {
+                context.screen =
+                  qApp->screens().indexOf(qApp->screenAt(area.center()));
+            }
+            saveToFilesystem(capture, path, "", context);
         }
     }
 
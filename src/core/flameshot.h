@@ -7,8 +7,11 @@
 #include <QObject>
 #include <QPointer>
 #include <QVersionNumber>
+#include <functional>
 
 class CaptureWidget;
+class SelectorWidget;
+class RegionGrabWidget;
 class ConfigWindow;
 class InfoWindow;
 class CaptureLauncher;
@@ -36,6 +39,8 @@ public slots:
       const CaptureRequest& req = CaptureRequest::GRAPHICAL_MODE);
     void screen(CaptureRequest req, int const screenNumber = -1);
     void full(const CaptureRequest& req);
+    void scroll(const CaptureRequest& req);
+    void record(const CaptureRequest& req);
     void launcher();
     void config();
 
@@ -60,17 +65,23 @@ public slots:
     void requestCapture(const CaptureRequest& request);
     void exportCapture(const QPixmap& p,
                        QRect& selection,
-                       const CaptureRequest& req);
+                       const CaptureRequest& req,
+                       const QRect& logicalSelection = QRect());
 
 private:
     Flameshot();
     bool resolveAnyConfigErrors();
+    void grabRegion(
+      const CaptureRequest& req,
+      const std::function<RegionGrabWidget*(const QRect&)>& start);
 
     // class members
     static Origin m_origin;
     bool m_haveExternalWidget;
 
     QPointer<CaptureWidget> m_captureWindow;
+    QPointer<SelectorWidget> m_selectorWindow;
+    QPointer<RegionGrabWidget> m_regionGrabWindow;
     QPointer<InfoWindow> m_infoWindow;
     QPointer<CaptureLauncher> m_launcherWindow;
     QPointer<ConfigWindow> m_configWindow;
@@ -5,7 +5,11 @@
 #include "flameshot.h"
 #include "pinwidget.h"
 #include "screenshotsaver.h"
+#include "src/tools/launcher/capturetempfile.h"
+#include "src/utils/fontfamilyindex.h"
 #include "src/utils/globalvalues.h"
+#include "src/utils/iconatlas.h"
+#include "src/utils/metrics.h"
 #include "src/widgets/capture/capturewidget.h"
 #include "src/widgets/capture/notifierbox.h"
 #include "src/widgets/trayicon.h"
@@ -15,6 +19,7 @@
 #include <QDBusMessage>
 #include <QPixmap>
 #include <QRect>
+#include <algorithm>
 
 #if !defined(DISABLE_UPDATE_CHECKER)
 #include <QDesktopServices>
@@ -77,6 +82,17 @@ FlameshotDaemon::FlameshotDaemon()
           m_hostingClipboard = false;
           quitIfIdle();
       });
+    Metrics::instance()->setGauge(QStringLiteral("pins"),
+                                  [this]() { return countPins(); });
+    Metrics::instance()->setGauge(QStringLiteral("pinMemory"),
+                                  [this]() { return pinMemoryUsage(); });
+    // Load the icons saved by a previous daemon now, not when the first
+    // capture widget opens
+    IconAtlas::instance();
+    // Enumerating the fonts can take seconds, the text tool must not wait
+    FontFamilyIndex::instance()->load();
+    // The captures opened with other applications by a previous daemon
+    CaptureTempFile::removeStale();
 #ifdef Q_OS_WIN
     m_persist = true;
 #else
@@ -284,6 +300,50 @@ void FlameshotDaemon::quitIfIdle()
 
 // SERVICE METHODS
 
+qsizetype FlameshotDaemon::countPins()
+{
+    return m_widgets.size();
+}
+
+qint64 FlameshotDaemon::pinMemoryUsage()
+{
+    qint64 bytes = 0;
+    for (auto& w : m_widgets) {
+        bytes += static_cast<PinWidget*>(w)->memoryUsage();
+    }
+    return bytes;
+}
+
+void FlameshotDaemon::enforcePinMemoryBudget(PinWidget* current)
+{
+    const qint64 budget =
+      static_cast<qint64>(ConfigHandler().pinMemoryBudget()) * 1024 * 1024;
+    qint64 usage = pinMemoryUsage();
+    if (budget <= 0 || usage <= budget) {
+        return;
+    }
+    // The pin being used is never compacted, the others are from the least
+    // recently used one
+    QList<PinWidget*> pins;
+    for (auto& w : m_widgets) {
+        auto* pin = static_cast<PinWidget*>(w);
+        if (pin != current && !pin->isCompacted()) {
+            pins.append(pin);
+        }
+    }
+    std::sort(pins.begin(), pins.end(), [](PinWidget* a, PinWidget* b) {
+        return a->lastUsed() < b->lastUsed();
+    });
+    for (auto* pin : pins) {
+        if (usage <= budget) {
+            break;
+        }
+        const qint64 before = pin->memoryUsage();
+        pin->compact();
+        usage -= before - pin->memoryUsage();
+    }
+}
+
 void FlameshotDaemon::attachPin(const QPixmap& pixmap, QRect geometry, const QByteArray& args)
 {
     auto* pinWidget = new PinWidget(pixmap, geometry, args);
@@ -292,6 +352,10 @@ void FlameshotDaemon::attachPin(const QPixmap& pixmap, QRect geometry, const QBy
         m_widgets.removeOne(pinWidget);
         quitIfIdle();
     });
+    connect(pinWidget, &PinWidget::originalRestored, this, [=]() {
+        enforcePinMemoryBudget(pinWidget);
+    });
+    enforcePinMemoryBudget(pinWidget);
 
     pinWidget->show();
     pinWidget->activateWindow();
@@ -299,6 +363,7 @@ void FlameshotDaemon::attachPin(const QPixmap& pixmap, QRect geometry, const QBy
 
 void FlameshotDaemon::attachScreenshotToClipboard(const QPixmap& pixmap)
 {
+    Metrics::Timer timer(QStringLiteral("clipboard"));
     m_hostingClipboard = true;
     QClipboard* clipboard = QApplication::clipboard();
     clipboard->blockSignals(true);
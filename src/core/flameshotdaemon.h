@@ -11,6 +11,7 @@ class QDBusConnection;
 class TrayIcon;
 class CaptureWidget;
 class NotifierBox;
+class PinWidget;
 
 #if !defined(DISABLE_UPDATE_CHECKER)
 class QNetworkAccessManager;
@@ -39,6 +40,9 @@ public:
       const QString& title = QStringLiteral("Flameshot Info"),
       const int timeout = 5000);
     qsizetype countMouseTransparent();
+    qsizetype countPins();
+    // Bytes used by all the pins
+    qint64 pinMemoryUsage();
 
 #if !defined(DISABLE_UPDATE_CHECKER)
     void showUpdateNotificationIfAvailable(CaptureWidget* widget);
@@ -58,6 +62,7 @@ signals:
 private:
     FlameshotDaemon();
     void quitIfIdle();
+    void enforcePinMemoryBudget(PinWidget* current);
     void attachScreenshotToClipboard(const QPixmap& pixmap);
 
     void attachPin(const QByteArray& data);
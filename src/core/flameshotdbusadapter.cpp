@@ -3,6 +3,20 @@
 
 #include "flameshotdbusadapter.h"
 #include "src/core/flameshotdaemon.h"
+#include "src/utils/imagefdwriter.h"
+#include "src/utils/metrics.h"
+#include "src/utils/screengrabber.h"
+#include <QApplication>
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDBusUnixFileDescriptor>
+#include <QImageWriter>
+#include <QJsonDocument>
+#include <QThreadPool>
+
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
 
 FlameshotDBusAdapter::FlameshotDBusAdapter(QObject* parent)
   : QDBusAbstractAdaptor(parent)
@@ -25,3 +39,95 @@ void FlameshotDBusAdapter::attachPin(const QByteArray& data)
 {
     FlameshotDaemon::instance()->attachPin(data);
 }
+
+QString FlameshotDBusAdapter::getMetrics()
+{
+    return QString::fromUtf8(
+      QJsonDocument(Metrics::instance()->snapshot()).toJson());
+}
+
+/**
+ * @brief Capture without any user interaction and write the image into `fd`.
+ * @param fd Descriptor to write to, usually the write end of a pipe. The
+ * data ends when the daemon closes its copy of the descriptor.
+ * @param region Part of the capture to keep, the whole capture if null
+ * @param screen Index of the screen to capture, all the screens if negative
+ * @param format "raw" for RGBA8888 pixels without any header, or any format
+ * supported by QImageWriter
+ * @param message The call itself, filled in by QtDBus and not part of the
+ * D-Bus signature
+ * @return Size of the image in pixels, or an error reply
+ *
+ * Only the grab runs in the call, encoding and writing are done in a thread
+ * pool, so several captures can be written at the same time.
+ */
+QSize FlameshotDBusAdapter::captureToFd(const QDBusUnixFileDescriptor& fd,
+                                        const QRect& region,
+                                        int screen,
+                                        const QString& format,
+                                        const QDBusMessage& message)
+{
+#ifdef Q_OS_UNIX
+    QByteArray imageFormat = format.toLower().toLatin1();
+    if (imageFormat != "raw" &&
+        !QImageWriter::supportedImageFormats().contains(imageFormat)) {
+        return replyError(message,
+                          QDBusError::InvalidArgs,
+                          tr("Unsupported image format: %1").arg(format));
+    }
+    if (!fd.isValid()) {
+        return replyError(message,
+                          QDBusError::InvalidArgs,
+                          tr("Invalid file descriptor"));
+    }
+    if (screen >= qApp->screens().size()) {
+        return replyError(message,
+                          QDBusError::InvalidArgs,
+                          tr("Requested screen exceeds screen count"));
+    }
+
+    bool ok = true;
+    QPixmap capture = screen < 0 ? ScreenGrabber().grabEntireDesktop(ok)
+                                 : ScreenGrabber().grabScreen(
+                                     qApp->screens().at(screen), ok);
+    if (!ok) {
+        return replyError(message,
+                          QDBusError::Failed,
+                          tr("Unable to capture screen"));
+    }
+    if (!region.isNull()) {
+        capture = capture.copy(region.intersected(capture.rect()));
+    }
+
+    // The descriptor received over D-Bus is closed when `fd` is destroyed
+    int descriptor = ::dup(fd.fileDescriptor());
+    if (descriptor < 0) {
+        return replyError(message,
+                          QDBusError::Failed,
+                          tr("Invalid file descriptor"));
+    }
+    QImage image = capture.toImage();
+    ImageFdWriter::pool()->start(
+      new ImageFdWriter(image, descriptor, imageFormat));
+    return image.size();
+#else
+    Q_UNUSED(fd)
+    Q_UNUSED(region)
+    Q_UNUSED(screen)
+    Q_UNUSED(format)
+    return replyError(message,
+                      QDBusError::NotSupported,
+                      tr("File descriptors can't be passed on this platform"));
+#endif
+}
+
+// Errors are replied by hand: the call context of QDBusContext is only given
+// to the exported object, never to its adaptors
+QSize FlameshotDBusAdapter::replyError(const QDBusMessage& message,
+                                       QDBusError::ErrorType type,
+                                       const QString& text)
+{
+    message.setDelayedReply(true);
+    QDBusConnection::sessionBus().send(message.createErrorReply(type, text));
+    return {};
+}
@@ -3,7 +3,12 @@
 
 #pragma once
 
+#include <QSize>
 #include <QtDBus/QDBusAbstractAdaptor>
+#include <QtDBus/QDBusError>
+
+class QDBusMessage;
+class QDBusUnixFileDescriptor;
 
 class FlameshotDBusAdapter : public QDBusAbstractAdaptor
 {
@@ -19,4 +24,16 @@ public slots:
     Q_NOREPLY void attachTextToClipboard(const QString& text,
                                          const QString& notification);
     Q_NOREPLY void attachPin(const QByteArray& data);
+    // JSON object with the counters, gauges and latency histograms
+    QString getMetrics();
+    QSize captureToFd(const QDBusUnixFileDescriptor& fd,
+                      const QRect& region,
+                      int screen,
+                      const QString& format,
+                      const QDBusMessage& message);
+
+private:
+    static QSize replyError(const QDBusMessage& message,
+                            QDBusError::ErrorType type,
+                            const QString& text);
 };
@@ -9,6 +9,7 @@
 
 #include "abstractlogger.h"
 #include "src/cli/commandlineparser.h"
+#include "src/cli/renderbatch.h"
 #include "src/config/cacheutils.h"
 #include "src/config/styleoverride.h"
 #include "src/core/capturerequest.h"
@@ -21,8 +22,10 @@
 #include "src/widgets/trayicon.h"
 #include <QApplication>
 #include <QDir>
+#include <QFile>
 #include <QLibraryInfo>
 #include <QSharedMemory>
+#include <QThread>
 #include <QTimer>
 #include <QTranslator>
 #if defined(Q_OS_LINUX) || defined(Q_OS_UNIX)
@@ -232,6 +235,20 @@ int main(int argc, char* argv[])
     CommandArgument screenArgument(
       QStringLiteral("screen"),
       QObject::tr("Capture a screenshot of the specified monitor."));
+    CommandArgument scrollArgument(
+      QStringLiteral("scroll"),
+      QObject::tr("Capture a region taller than the screen while its content "
+                  "is scrolled."));
+    CommandArgument recordArgument(
+      QStringLiteral("record"),
+      QObject::tr("Record a region of the screen to an animated GIF."));
+    CommandArgument statsArgument(
+      QStringLiteral("stats"),
+      QObject::tr("Print the metrics of the running daemon as JSON."));
+    CommandArgument renderArgument(
+      QStringLiteral("render"),
+      QObject::tr("Draw annotations on images, one JSON job per line of the "
+                  "standard input."));
 
     // Options
     CommandOption pathOption(
@@ -293,6 +310,20 @@ int main(int argc, char* argv[])
         QObject::tr("default: screen containing the cursor"),
       QObject::tr("Screen number"),
       QStringLiteral("-1"));
+    CommandOption fpsOption(
+      "fps",
+      QObject::tr("Frames per second of the recording") + ",\n" +
+        QObject::tr("default: 10"),
+      QStringLiteral("fps"));
+    CommandOption durationOption(
+      "duration",
+      QObject::tr("Stop the recording after this many seconds"),
+      QStringLiteral("seconds"));
+    CommandOption jobsOption(
+      { "j", "jobs" },
+      QObject::tr("Number of images rendered at the same time") + ",\n" +
+        QObject::tr("0 or default: one per processor core"),
+      QStringLiteral("jobs"));
 
     // Add checkers
     auto colorChecker = [](const QString& colorCode) -> bool {
@@ -312,6 +343,12 @@ int main(int argc, char* argv[])
       QObject::tr("Invalid delay, it must be a number greater than 0");
     const QString numberErr =
       QObject::tr("Invalid screen number, it must be non negative");
+    const QString fpsErr =
+      QObject::tr("Invalid frame rate, it must be between 1 and 50");
+    const QString durationErr =
+      QObject::tr("Invalid duration, it must be a number greater than 0");
+    const QString jobsErr =
+      QObject::tr("Invalid number of jobs, it must be 0 or greater");
     const QString regionErr = QObject::tr(
       "Invalid region, use 'WxH+X+Y' or 'all' or 'screen0/screen1/...'.");
     auto numericChecker = [](const QString& delayValue) -> bool {
@@ -354,13 +391,26 @@ int main(int argc, char* argv[])
     autostartOption.addChecker(booleanChecker, booleanErr);
     showHelpOption.addChecker(booleanChecker, booleanErr);
     screenNumberOption.addChecker(numericChecker, numberErr);
+    fpsOption.addChecker(
+      [](const QString& value) -> bool {
+          bool ok;
+          int fps = value.toInt(&ok);
+          return ok && fps >= 1 && fps <= 50;
+      },
+      fpsErr);
+    durationOption.addChecker(numericChecker, durationErr);
+    jobsOption.addChecker(numericChecker, jobsErr);
 
     // Relationships
     parser.AddArgument(guiArgument);
     parser.AddArgument(screenArgument);
     parser.AddArgument(fullArgument);
+    parser.AddArgument(scrollArgument);
+    parser.AddArgument(recordArgument);
     parser.AddArgument(launcherArgument);
     parser.AddArgument(configArgument);
+    parser.AddArgument(statsArgument);
+    parser.AddArgument(renderArgument);
     auto helpOption = parser.addHelpOption();
     auto versionOption = parser.addVersionOption();
     parser.AddOptions({ pathOption,
@@ -390,6 +440,17 @@ int main(int argc, char* argv[])
                         rawImageOption,
                         uploadOption },
                       fullArgument);
+    parser.AddOptions({ pathOption,
+                        clipboardOption,
+                        delayOption,
+                        regionOption,
+                        rawImageOption,
+                        uploadOption,
+                        pinOption },
+                      scrollArgument);
+    parser.AddOptions(
+      { pathOption, delayOption, regionOption, fpsOption, durationOption },
+      recordArgument);
     parser.AddOptions({ autostartOption,
                         filenameOption,
                         trayOption,
@@ -398,6 +459,7 @@ int main(int argc, char* argv[])
                         contrastColorOption,
                         checkOption },
                       configArgument);
+    parser.AddOption(jobsOption, renderArgument);
     // Parse
     if (!parser.parse(qApp->arguments())) {
         goto finish;
@@ -562,6 +624,105 @@ int main(int argc, char* argv[])
         }
 
         requestCaptureAndWait(req);
+    } else if (parser.isSet(scrollArgument)) { // SCROLL
+        reinitializeAsQApplication(argc, argv);
+
+        // Option values
+        QString path = parser.value(pathOption);
+        if (!path.isEmpty()) {
+            path = QDir(path).absolutePath();
+        }
+        int delay = parser.value(delayOption).toInt();
+        QString region = parser.value(regionOption);
+        bool clipboard = parser.isSet(clipboardOption);
+        bool raw = parser.isSet(rawImageOption);
+        bool pin = parser.isSet(pinOption);
+        bool upload = parser.isSet(uploadOption);
+
+        CaptureRequest req(CaptureRequest::SCROLL_MODE, delay);
+        if (!region.isEmpty()) {
+            req.setInitialSelection(Region().value(region).toRect());
+        }
+        if (clipboard) {
+            req.addTask(CaptureRequest::COPY);
+        }
+        if (!path.isEmpty()) {
+            req.addSaveTask(path);
+        }
+        if (raw) {
+            req.addTask(CaptureRequest::PRINT_RAW);
+        }
+        if (pin) {
+            req.addTask(CaptureRequest::PIN);
+        }
+        if (upload) {
+            req.addTask(CaptureRequest::UPLOAD);
+        }
+        if (!clipboard && path.isEmpty() && !raw && !pin && !upload) {
+            req.addSaveTask();
+        }
+        requestCaptureAndWait(req);
+    } else if (parser.isSet(recordArgument)) { // RECORD
+        reinitializeAsQApplication(argc, argv);
+
+        // Option values
+        QString path = parser.value(pathOption);
+        if (!path.isEmpty()) {
+            path = QDir(path).absolutePath();
+        }
+        int delay = parser.value(delayOption).toInt();
+        QString region = parser.value(regionOption);
+        QVariantMap options;
+        if (parser.isSet(fpsOption)) {
+            options[QStringLiteral("fps")] = parser.value(fpsOption).toInt();
+        }
+        if (parser.isSet(durationOption)) {
+            options[QStringLiteral("duration")] =
+              parser.value(durationOption).toInt();
+        }
+
+        CaptureRequest req(CaptureRequest::RECORD_MODE, delay, options);
+        if (!region.isEmpty()) {
+            req.setInitialSelection(Region().value(region).toRect());
+        }
+        req.addSaveTask(path);
+        requestCaptureAndWait(req);
+    } else if (parser.isSet(statsArgument)) { // STATS
+#if !(defined(Q_OS_MACOS) || defined(Q_OS_WIN))
+        QDBusMessage m = QDBusMessage::createMethodCall(
+          QStringLiteral("org.flameshot.Flameshot"),
+          QStringLiteral("/"),
+          QLatin1String(""),
+          QStringLiteral("getMetrics"));
+        QDBusMessage reply = QDBusConnection::sessionBus().call(m);
+        if (reply.type() != QDBusMessage::ReplyMessage ||
+            reply.arguments().isEmpty()) {
+            AbstractLogger::error(AbstractLogger::Stderr)
+              << QObject::tr("Unable to get the metrics, is the Flameshot "
+                             "daemon running?");
+            return 1;
+        }
+        QTextStream(stdout) << reply.arguments().first().toString();
+#else
+        AbstractLogger::error(AbstractLogger::Stderr)
+          << QObject::tr("Metrics are only available through D-Bus.");
+        return 1;
+#endif
+    } else if (parser.isSet(renderArgument)) { // RENDER
+        // The tools only paint on images, no display is needed
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+        reinitializeAsQApplication(argc, argv);
+        int jobs = parser.value(jobsOption).toInt();
+        if (jobs <= 0) {
+            jobs = QThread::idealThreadCount();
+        }
+        // The first ConfigHandler sets up the file watcher, on this thread
+        // rather than on a worker
+        ConfigHandler();
+        QFile input, output;
+        input.open(stdin, QIODevice::ReadOnly);
+        output.open(stdout, QIODevice::WriteOnly);
+        return RenderBatch(jobs).run(input, output) ? 0 : 1;
     } else if (parser.isSet(configArgument)) { // CONFIG
         bool autostart = parser.isSet(autostartOption);
         bool filename = parser.isSet(filenameOption);
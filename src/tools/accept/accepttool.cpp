@@ -23,7 +23,7 @@ bool AcceptTool::closeOnButtonPressed() const
 QIcon AcceptTool::icon(const QColor& background, bool inEditor) const
 {
     Q_UNUSED(inEditor)
-    return QIcon(iconPath(background) + "accept.svg");
+    return IconAtlas::icon(iconPath(background) + "accept.svg");
 }
 
 QString AcceptTool::name() const
@@ -0,0 +1,138 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "annotationrenderer.h"
+#include "src/tools/capturecontext.h"
+#include "src/tools/toolfactory.h"
+#include <QJsonObject>
+#include <QMetaEnum>
+#include <QPainter>
+#include <QPixmap>
+
+#define DEFAULT_SIZE 3
+
+bool AnnotationRenderer::parse(const QJsonArray& json,
+                               QVector<Annotation>& annotations,
+                               QString& error)
+{
+    const QMetaEnum types = QMetaEnum::fromType<CaptureTool::Type>();
+    annotations.clear();
+    annotations.reserve(json.size());
+    for (int i = 0; i < json.size(); ++i) {
+        const QJsonObject object = json.at(i).toObject();
+        const QString tool = object.value(QStringLiteral("tool")).toString();
+        bool ok = false;
+        int type = types.keyToValue(
+          ("TYPE_" + tool.toUpper()).toLatin1().constData(), &ok);
+        if (!ok || !isSupported(static_cast<CaptureTool::Type>(type))) {
+            error = QStringLiteral("annotation %1: unknown tool '%2'")
+                      .arg(i)
+                      .arg(tool);
+            return false;
+        }
+
+        Annotation annotation;
+        annotation.type = static_cast<CaptureTool::Type>(type);
+        annotation.color = QColor(
+          object.value(QStringLiteral("color")).toString(QStringLiteral("red")));
+        if (!annotation.color.isValid()) {
+            error = QStringLiteral("annotation %1: invalid color").arg(i);
+            return false;
+        }
+        annotation.size =
+          object.value(QStringLiteral("size")).toInt(DEFAULT_SIZE);
+        annotation.text = object.value(QStringLiteral("text")).toString();
+        for (const QJsonValue& point :
+             object.value(QStringLiteral("points")).toArray()) {
+            const QJsonArray xy = point.toArray();
+            if (xy.size() != 2) {
+                error = QStringLiteral("annotation %1: points must be [x, y]")
+                          .arg(i);
+                return false;
+            }
+            annotation.points << QPoint(xy.at(0).toInt(), xy.at(1).toInt());
+        }
+        if (annotation.points.isEmpty()) {
+            error = QStringLiteral("annotation %1: no points").arg(i);
+            return false;
+        }
+        annotations << annotation;
+    }
+    return true;
+}
+
+/**
+ * @brief Returns `image` with the annotations drawn on it in order, the same
+ * way the capture widget draws its tool objects.
+ */
+QImage AnnotationRenderer::render(const QImage& image,
+                                  const QVector<Annotation>& annotations)
+{
+    QImage canvas = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    QObject parent;
+    ToolFactory factory;
+    int circleCount = 1;
+    for (const Annotation& annotation : annotations) {
+        CaptureTool* tool = factory.CreateTool(annotation.type, &parent);
+        CaptureContext context;
+        context.color = annotation.color;
+        context.toolSize = annotation.size;
+        context.circleCount = circleCount;
+        context.mousePos = annotation.points.first();
+        context.fullscreen = false;
+        tool->drawStart(context);
+        for (int i = 1; i < annotation.points.size(); ++i) {
+            tool->drawMove(annotation.points.at(i));
+        }
+        tool->drawEnd(annotation.points.last());
+
+        if (annotation.type == CaptureTool::TYPE_CIRCLECOUNT) {
+            tool->setCount(circleCount++);
+        } else if (annotation.type == CaptureTool::TYPE_TEXT) {
+            // The text widget is not created, set what it would have typed
+            tool->onSizeChanged(annotation.size);
+            QMetaObject::invokeMethod(tool,
+                                      "updateText",
+                                      Qt::DirectConnection,
+                                      Q_ARG(QString, annotation.text));
+        }
+
+        // Only the tools reading the image back need it as a pixmap, the
+        // others draw straight into the QImage
+        QPixmap source;
+        if (readsPixels(annotation.type)) {
+            source = QPixmap::fromImage(canvas);
+        }
+        QPainter painter(&canvas);
+        painter.setRenderHint(QPainter::Antialiasing);
+        tool->process(painter, source);
+        delete tool;
+    }
+    return canvas;
+}
+
+bool AnnotationRenderer::isSupported(CaptureTool::Type type)
+{
+    switch (type) {
+        case CaptureTool::TYPE_PENCIL:
+        case CaptureTool::TYPE_DRAWER:
+        case CaptureTool::TYPE_ARROW:
+        case CaptureTool::TYPE_SELECTION:
+        case CaptureTool::TYPE_RECTANGLE:
+        case CaptureTool::TYPE_CIRCLE:
+        case CaptureTool::TYPE_MARKER:
+        case CaptureTool::TYPE_PIXELATE:
+        case CaptureTool::TYPE_TEXT:
+        case CaptureTool::TYPE_CIRCLECOUNT:
+        case CaptureTool::TYPE_INVERT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool AnnotationRenderer::readsPixels(CaptureTool::Type type)
+{
+    return type == CaptureTool::TYPE_PIXELATE ||
+           type == CaptureTool::TYPE_INVERT;
+}
@@ -0,0 +1,48 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include "src/tools/capturetool.h"
+#include <QColor>
+#include <QImage>
+#include <QJsonArray>
+#include <QPoint>
+#include <QString>
+#include <QVector>
+
+// Draws annotations on an image with the CaptureTool implementations of the
+// capture widget, but without any widget, so that it can run on any thread.
+// Used by `flameshot render`.
+class AnnotationRenderer
+{
+public:
+    struct Annotation
+    {
+        CaptureTool::Type type;
+        QColor color;
+        int size;
+        // The path tools use every point, the other tools the first and the
+        // last one
+        QVector<QPoint> points;
+        // Only for the text tool
+        QString text;
+    };
+
+    // Reads a list of annotations in the form
+    // [{"tool": "arrow", "color": "#ff0000", "size": 4,
+    //   "points": [[10, 10], [200, 120]]},
+    //  {"tool": "text", "points": [[20, 20]], "text": "Click here"}]
+    // The tool names are the ones of the shortcuts without the TYPE_ prefix.
+    // Stops at the first invalid annotation and describes it in `error`.
+    static bool parse(const QJsonArray& json,
+                      QVector<Annotation>& annotations,
+                      QString& error);
+
+    static QImage render(const QImage& image,
+                         const QVector<Annotation>& annotations);
+
+private:
+    static bool isSupported(CaptureTool::Type type);
+    static bool readsPixels(CaptureTool::Type type);
+};
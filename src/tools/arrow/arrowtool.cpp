@@ -69,7 +69,7 @@ ArrowTool::ArrowTool(QObject* parent)
 QIcon ArrowTool::icon(const QColor& background, bool inEditor) const
 {
     Q_UNUSED(inEditor)
-    return QIcon(iconPath(background) + "arrow-bottom-left.svg");
+    return IconAtlas::icon(iconPath(background) + "arrow-bottom-left.svg");
 }
 QString ArrowTool::name() const
 {
@@ -133,6 +133,19 @@ QRect ArrowTool::boundingRect() const
     return rect.normalized();
 }
 
+// The head is only laid out by process(), so it can't be taken from
+// boundingRect() before the first paint. It never gets further from the line
+// than half of its base.
+QRect ArrowTool::paintedRect() const
+{
+    if (!isValid()) {
+        return {};
+    }
+    int margin = ArrowWidth / 2 + size() + 2;
+    return QRect(points().first, points().second).normalized() +
+           QMargins(margin, margin, margin, margin);
+}
+
 CaptureTool* ArrowTool::copy(QObject* parent)
 {
     auto* tool = new ArrowTool(parent);
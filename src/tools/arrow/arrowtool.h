@@ -17,6 +17,7 @@ public:
     QString name() const override;
     QString description() const override;
     QRect boundingRect() const override;
+    QRect paintedRect() const override;
 
     CaptureTool* copy(QObject* parent = nullptr) override;
     void process(QPainter& painter, const QPixmap& pixmap) override;
@@ -4,6 +4,7 @@
 #pragma once
 
 #include "capturerequest.h"
+#include "src/utils/imagetilestore.h"
 #include <QPainter>
 #include <QPixmap>
 #include <QPoint>
@@ -13,8 +14,8 @@ struct CaptureContext
 {
     // screenshot with modifications
     QPixmap screenshot;
-    // unmodified screenshot
-    QPixmap origScreenshot;
+    // unmodified tiles of the screenshot, saved before they are modified
+    ImageTileStore origTiles;
     // Selection area
     QRect selection;
     // Selected tool color
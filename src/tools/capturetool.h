@@ -5,6 +5,7 @@
 
 #include "src/tools/capturecontext.h"
 #include "src/utils/colorutils.h"
+#include "src/utils/iconatlas.h"
 #include "src/utils/pathinfo.h"
 #include <QIcon>
 #include <QPainter>
@@ -102,6 +103,18 @@ public:
         return {};
     };
     virtual QRect boundingRect() const = 0;
+    // Area that process() may paint on: boundingRect() grown by the pen
+    // width and the antialiasing. A tool that can't tell before painting
+    // returns a null rect and is assumed to paint on the whole pixmap.
+    virtual QRect paintedRect() const
+    {
+        QRect rect = boundingRect();
+        if (rect.isNull()) {
+            return rect;
+        }
+        int margin = qMax(size(), 0) + 2;
+        return rect + QMargins(margin, margin, margin, margin);
+    }
 
     // The icon of the tool.
     // inEditor is true when the icon is requested inside the editor
@@ -3,12 +3,19 @@
 
 #include "circlecounttool.h"
 #include "colorutils.h"
+#include <QCache>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QPainter>
 #include <QPainterPath>
+#include <cmath>
 
 namespace {
 #define PADDING_VALUE 2
 #define THICKNESS_OFFSET 15
+// Memory of the cached bubble sprites, in bytes
+#define SPRITE_CACHE_COST (8 * 1024 * 1024)
 }
 
 CircleCountTool::CircleCountTool(QObject* parent)
@@ -19,7 +26,7 @@ CircleCountTool::CircleCountTool(QObject* parent)
 QIcon CircleCountTool::icon(const QColor& background, bool inEditor) const
 {
     Q_UNUSED(inEditor)
-    return QIcon(iconPath(background) + "circlecount-outline.svg");
+    return IconAtlas::icon(iconPath(background) + "circlecount-outline.svg");
 }
 
 QString CircleCountTool::info()
@@ -96,21 +103,13 @@ CaptureTool* CircleCountTool::copy(QObject* parent)
 void CircleCountTool::process(QPainter& painter, const QPixmap& pixmap)
 {
     Q_UNUSED(pixmap)
-    // save current pen, brush, and font state
-    auto orig_pen = painter.pen();
-    auto orig_brush = painter.brush();
-    auto orig_font = painter.font();
-
-    QColor contrastColor =
-      ColorUtils::colorIsDark(color()) ? Qt::white : Qt::black;
-    QColor antiContrastColor =
-      ColorUtils::colorIsDark(color()) ? Qt::black : Qt::white;
-
     int bubble_size = size() + THICKNESS_OFFSET;
 
     QLineF line(points().first, points().second);
     // if the mouse is outside of the bubble, draw the pointer
     if (line.length() > bubble_size) {
+        auto orig_pen = painter.pen();
+        auto orig_brush = painter.brush();
         painter.setPen(QPen(color(), 0));
         painter.setBrush(color());
 
@@ -129,49 +128,153 @@ void CircleCountTool::process(QPainter& painter, const QPixmap& pixmap)
         path.lineTo(p2);
         path.lineTo(points().first);
         painter.drawPath(path);
+        painter.setBrush(orig_brush);
+        painter.setPen(orig_pen);
     }
 
+    // A sprite drawn at a whole pixel offset gives the same pixels as
+    // drawing the bubble, anything else is drawn directly
+    const QTransform& transform = painter.worldTransform();
+    if (transform.type() <= QTransform::TxTranslate &&
+        transform.dx() == qRound(transform.dx()) &&
+        transform.dy() == qRound(transform.dy())) {
+        int center = spriteCenter(bubble_size);
+        painter.drawImage(points().first - QPoint(center, center),
+                          bubbleSprite(painter, bubble_size));
+    } else {
+        drawBubble(painter, points().first, bubble_size);
+    }
+}
+
+void CircleCountTool::drawBubble(QPainter& painter,
+                                 const QPoint& center,
+                                 int bubbleSize)
+{
+    // save current pen, brush, and font state
+    auto orig_pen = painter.pen();
+    auto orig_brush = painter.brush();
+    auto orig_font = painter.font();
+
+    QColor contrastColor =
+      ColorUtils::colorIsDark(color()) ? Qt::white : Qt::black;
+    QColor antiContrastColor =
+      ColorUtils::colorIsDark(color()) ? Qt::black : Qt::white;
+
     painter.setPen(contrastColor);
     painter.setBrush(antiContrastColor);
     painter.drawEllipse(
-      points().first, bubble_size + PADDING_VALUE, bubble_size + PADDING_VALUE);
+      center, bubbleSize + PADDING_VALUE, bubbleSize + PADDING_VALUE);
     painter.setBrush(color());
-    painter.drawEllipse(points().first, bubble_size, bubble_size);
-    QRect textRect = QRect(points().first.x() - bubble_size / 2,
-                           points().first.y() - bubble_size / 2,
-                           bubble_size,
-                           bubble_size);
+    painter.drawEllipse(center, bubbleSize, bubbleSize);
+    QRect textRect = QRect(center.x() - bubbleSize / 2,
+                           center.y() - bubbleSize / 2,
+                           bubbleSize,
+                           bubbleSize);
+    QString text = QString::number(count());
     auto new_font = orig_font;
-    auto fontSize = bubble_size;
-    new_font.setPixelSize(fontSize);
     new_font.setBold(true);
-    painter.setFont(new_font);
-
-    // Draw bounding circle
-    QRect bRect =
-      painter.boundingRect(textRect, Qt::AlignCenter, QString::number(count()));
-
-    // Calculate font size
-    while (bRect.width() > textRect.width()) {
-        fontSize--;
-        if (fontSize == 0) {
-            break;
-        }
-        new_font.setPixelSize(fontSize);
-        painter.setFont(new_font);
-        bRect = painter.boundingRect(
-          textRect, Qt::AlignCenter, QString::number(count()));
-    }
+    new_font.setPixelSize(fittedPixelSize(new_font, bubbleSize, text.size()));
 
     // Draw text
+    painter.setFont(new_font);
     painter.setPen(contrastColor);
-    painter.drawText(textRect, Qt::AlignCenter, QString::number(count()));
+    painter.drawText(textRect, Qt::AlignCenter, text);
     // restore original font, brush, and pen
     painter.setFont(orig_font);
     painter.setBrush(orig_brush);
     painter.setPen(orig_pen);
 }
 
+/**
+ * @brief Largest pixel size, from the bubble size down, at which a number of
+ * `digits` digits fits the bubble. The results are kept for every font.
+ */
+int CircleCountTool::fittedPixelSize(const QFont& font,
+                                     int bubbleSize,
+                                     int digits)
+{
+    static QMutex mutex;
+    static QHash<QString, int> fittedSizes;
+    const QString key =
+      QStringLiteral("%1/%2/%3").arg(font.key()).arg(bubbleSize).arg(digits);
+    {
+        QMutexLocker locker(&mutex);
+        auto it = fittedSizes.constFind(key);
+        if (it != fittedSizes.cend()) {
+            return it.value();
+        }
+    }
+
+    // The widest digit of most fonts, any number of this length fits then
+    const QString text(digits, QLatin1Char('8'));
+    const QRect textRect(0, 0, bubbleSize, bubbleSize);
+    QFont fitted = font;
+    int fontSize = bubbleSize;
+    fitted.setPixelSize(fontSize);
+    QRect bRect =
+      QFontMetrics(fitted).boundingRect(textRect, Qt::AlignCenter, text);
+    while (bRect.width() > textRect.width() && fontSize > 1) {
+        fontSize--;
+        fitted.setPixelSize(fontSize);
+        bRect =
+          QFontMetrics(fitted).boundingRect(textRect, Qt::AlignCenter, text);
+    }
+
+    QMutexLocker locker(&mutex);
+    fittedSizes.insert(key, fontSize);
+    return fontSize;
+}
+
+int CircleCountTool::spriteCenter(int bubbleSize)
+{
+    // Room for the outline drawn around the outer circle
+    return bubbleSize + PADDING_VALUE + 1;
+}
+
+/**
+ * @brief The bubble and its number for the device of `painter`, rendered
+ * once for every color, size and count and shared by all the counters and
+ * their undo copies. process() can run on several threads at once.
+ */
+QImage CircleCountTool::bubbleSprite(QPainter& painter, int bubbleSize)
+{
+    static QMutex mutex;
+    static QCache<QString, QImage> sprites(SPRITE_CACHE_COST);
+
+    const qreal ratio = painter.device()->devicePixelRatioF();
+    const bool antialiased = painter.testRenderHint(QPainter::Antialiasing);
+    const QString key = QStringLiteral("%1/%2/%3/%4/%5/%6")
+                          .arg(color().rgba())
+                          .arg(bubbleSize)
+                          .arg(count())
+                          .arg(painter.font().key())
+                          .arg(ratio)
+                          .arg(antialiased);
+    {
+        QMutexLocker locker(&mutex);
+        if (QImage* sprite = sprites.object(key)) {
+            return *sprite;
+        }
+    }
+
+    const int center = spriteCenter(bubbleSize);
+    const int side = static_cast<int>(std::ceil(center * 2 * ratio));
+    QImage sprite(side, side, QImage::Format_ARGB32_Premultiplied);
+    sprite.setDevicePixelRatio(ratio);
+    sprite.fill(Qt::transparent);
+    {
+        QPainter spritePainter(&sprite);
+        spritePainter.setRenderHint(QPainter::Antialiasing, antialiased);
+        spritePainter.setFont(painter.font());
+        drawBubble(spritePainter, QPoint(center, center), bubbleSize);
+    }
+
+    QMutexLocker locker(&mutex);
+    sprites.insert(
+      key, new QImage(sprite), static_cast<int>(sprite.bytesPerLine()) * side);
+    return sprite;
+}
+
 void CircleCountTool::paintMousePreview(QPainter& painter,
                                         const CaptureContext& context)
 {
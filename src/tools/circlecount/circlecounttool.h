@@ -34,6 +34,11 @@ public slots:
     void pressed(CaptureContext& context) override;
 
 private:
+    void drawBubble(QPainter& painter, const QPoint& center, int bubbleSize);
+    QImage bubbleSprite(QPainter& painter, int bubbleSize);
+    static int fittedPixelSize(const QFont& font, int bubbleSize, int digits);
+    static int spriteCenter(int bubbleSize);
+
     QString m_tempString;
     bool m_valid;
 };
@@ -15,7 +15,7 @@ bool ImgUploaderTool::closeOnButtonPressed() const
 QIcon ImgUploaderTool::icon(const QColor& background, bool inEditor) const
 {
     Q_UNUSED(inEditor);
-    return QIcon(iconPath(background) + "cloud-upload.svg");
+    return IconAtlas::icon(iconPath(background) + "cloud-upload.svg");
 }
 
 QString ImgUploaderTool::name() const
@@ -3,6 +3,7 @@
 
 #include "imguploaderbase.h"
 #include "src/core/flameshotdaemon.h"
+#include "src/tools/imgupload/uploadqueue.h"
 #include "src/utils/confighandler.h"
 #include "src/utils/globalvalues.h"
 #include "src/utils/history.h"
@@ -93,6 +94,31 @@ void ImgUploaderBase::setInfoLabelText(const QString& text)
     m_infoLabel->setText(text);
 }
 
+void ImgUploaderBase::trackUpload(UploadTask* task)
+{
+    connect(task,
+            &UploadTask::progress,
+            this,
+            [this](qint64 sent, qint64 total) {
+                if (total > 0) {
+                    setInfoLabelText(
+                      tr("Uploading Image (%1%)").arg(sent * 100 / total));
+                }
+            });
+    connect(
+      task, &UploadTask::retrying, this, [this](int attempt, int delayMs) {
+          setInfoLabelText(tr("Upload attempt %1 failed, retrying in %2 s")
+                             .arg(attempt)
+                             .arg(qMax(1, delayMs / 1000)));
+      });
+    connect(task, &UploadTask::failed, this, [this](const QString& error) {
+        m_spinner->deleteLater();
+        setInfoLabelText(error);
+        new QShortcut(Qt::Key_Escape, this, SLOT(close()));
+    });
+    connect(this, &QObject::destroyed, task, &UploadTask::cancel);
+}
+
 void ImgUploaderBase::startDrag()
 {
     auto* mimeData = new QMimeData;
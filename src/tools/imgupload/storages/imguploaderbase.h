@@ -15,6 +15,7 @@ class LoadSpinner;
 class QPushButton;
 class QUrl;
 class NotificationWidget;
+class UploadTask;
 
 class ImgUploaderBase : public QWidget
 {
@@ -42,6 +43,11 @@ signals:
 public slots:
     void showPostUploadDialog();
 
+protected:
+    // Shows the progress of `task`, which is cancelled when the widget is
+    // closed
+    void trackUpload(UploadTask* task);
+
 private slots:
     void startDrag();
     void openURL();
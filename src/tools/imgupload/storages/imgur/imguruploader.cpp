@@ -2,16 +2,16 @@
 // SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
 
 #include "imguruploader.h"
+#include "src/tools/imgupload/uploadqueue.h"
 #include "src/utils/confighandler.h"
 #include "src/utils/filenamehandler.h"
 #include "src/utils/history.h"
+#include "src/utils/metrics.h"
 #include "src/widgets/loadspinner.h"
 #include "src/widgets/notificationwidget.h"
-#include <QBuffer>
 #include <QDesktopServices>
 #include <QJsonDocument>
 #include <QJsonObject>
-#include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QNetworkRequest>
 #include <QShortcut>
@@ -19,18 +19,17 @@
 
 ImgurUploader::ImgurUploader(const QPixmap& capture, QWidget* parent)
   : ImgUploaderBase(capture, parent)
-{
-    m_NetworkAM = new QNetworkAccessManager(this);
-    connect(m_NetworkAM,
-            &QNetworkAccessManager::finished,
-            this,
-            &ImgurUploader::handleReply);
-}
+{}
 
 void ImgurUploader::handleReply(QNetworkReply* reply)
 {
     spinner()->deleteLater();
     m_currentImageName.clear();
+    Metrics::instance()->recordLatency(QStringLiteral("upload"),
+                                       m_uploadTimer.nsecsElapsed() / 1000);
+    Metrics::instance()->increment(reply->error() == QNetworkReply::NoError
+                                     ? QStringLiteral("uploads")
+                                     : QStringLiteral("uploadErrors"));
     if (reply->error() == QNetworkReply::NoError) {
         QJsonDocument response = QJsonDocument::fromJson(reply->readAll());
         QJsonObject json = response.object();
@@ -61,9 +60,7 @@ void ImgurUploader::handleReply(QNetworkReply* reply)
 
 void ImgurUploader::upload()
 {
-    QByteArray byteArray;
-    QBuffer buffer(&byteArray);
-    pixmap().save(&buffer, "PNG");
+    m_uploadTimer.start();
 
     QUrlQuery urlQuery;
     urlQuery.addQueryItem(QStringLiteral("title"), QStringLiteral(""));
@@ -73,14 +70,15 @@ void ImgurUploader::upload()
     QUrl url(QStringLiteral("https://api.imgur.com/3/image"));
     url.setQuery(urlQuery);
     QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::ContentTypeHeader,
-                      "application/application/x-www-form-urlencoded");
     request.setRawHeader("Authorization",
                          QStringLiteral("Client-ID %1")
                            .arg(ConfigHandler().uploadClientSecret())
                            .toUtf8());
 
-    m_NetworkAM->post(request, byteArray);
+    UploadTask* task = UploadQueue::instance()->enqueue(
+      request, QStringLiteral("image"), pixmap().toImage());
+    trackUpload(task);
+    connect(task, &UploadTask::finished, this, &ImgurUploader::handleReply);
 }
 
 void ImgurUploader::deleteImage(const QString& fileName,
@@ -4,11 +4,11 @@
 #pragma once
 
 #include "src/tools/imgupload/storages/imguploaderbase.h"
+#include <QElapsedTimer>
 #include <QUrl>
 #include <QWidget>
 
 class QNetworkReply;
-class QNetworkAccessManager;
 class QUrl;
 
 class ImgurUploader : public ImgUploaderBase
@@ -25,5 +25,5 @@ private:
     void upload();
 
 private:
-    QNetworkAccessManager* m_NetworkAM;
+    QElapsedTimer m_uploadTimer;
 };
@@ -0,0 +1,253 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "uploadqueue.h"
+#include "src/utils/confighandler.h"
+#include "src/utils/metrics.h"
+#include "src/utils/pngoptimizer.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QHttpMultiPart>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QTemporaryFile>
+#include <QThread>
+#include <QTimer>
+
+// Writes the capture of a task to its temporary file
+class UploadEncoder : public QThread
+{
+public:
+    UploadEncoder(const QImage& image, const QString& path, QObject* parent)
+      : QThread(parent)
+      , image(image)
+      , path(path)
+      , optimize(ConfigHandler().optimizePngOnUpload())
+      , dither(ConfigHandler().optimizePngDither())
+      , ok(false)
+    {}
+
+    ~UploadEncoder() override { wait(); }
+
+    void run() override
+    {
+        Metrics::Timer timer(QStringLiteral("encode.upload"));
+        QFile file(path);
+        if (!file.open(QIODevice::WriteOnly)) {
+            return;
+        }
+        const QImage encoded =
+          optimize ? PngOptimizer::optimize(image, dither) : image;
+        ok = encoded.save(&file, "PNG");
+    }
+
+    QImage image;
+    QString path;
+    bool optimize;
+    bool dither;
+    bool ok;
+};
+
+UploadTask::UploadTask(QObject* parent)
+  : QObject(parent)
+  , m_file(nullptr)
+  , m_encoder(nullptr)
+  , m_attempt(0)
+  , m_encoded(false)
+  , m_cancelled(false)
+{}
+
+UploadTask::~UploadTask()
+{
+    // The children are deleted in the order they were made, the file would
+    // be removed before the encoder is done with it and then written again
+    delete m_encoder;
+}
+
+void UploadTask::cancel()
+{
+    UploadQueue::instance()->cancel(this);
+}
+
+UploadQueue* UploadQueue::instance()
+{
+    // Owned by the application, the network access manager must be gone
+    // before it
+    static auto* queue = new UploadQueue(qApp);
+    return queue;
+}
+
+UploadQueue::UploadQueue(QObject* parent)
+  : QObject(parent)
+  , m_network(new QNetworkAccessManager(this))
+  , m_running(0)
+{}
+
+UploadTask* UploadQueue::enqueue(const QNetworkRequest& request,
+                                 const QString& field,
+                                 const QImage& image)
+{
+    auto* task = new UploadTask(this);
+    task->m_request = request;
+    task->m_field = field;
+    task->m_file = new QTemporaryFile(
+      QDir::tempPath() + "/flameshot-upload-XXXXXX.png", task);
+    m_pending.append(task);
+
+    // Only creates the file, the encoder writes it
+    if (!task->m_file->open()) {
+        // Reported once the caller is connected
+        QTimer::singleShot(0, task, [this, task]() {
+            if (task->m_cancelled) {
+                return;
+            }
+            m_pending.removeOne(task);
+            emit task->failed(tr("Unable to write the image to upload"));
+            task->deleteLater();
+        });
+        return task;
+    }
+    task->m_file->close();
+
+    auto* encoder = new UploadEncoder(image, task->m_file->fileName(), task);
+    task->m_encoder = encoder;
+    connect(encoder, &QThread::finished, task, [this, task, encoder]() {
+        const bool ok = encoder->ok;
+        task->m_encoder = nullptr;
+        encoder->deleteLater();
+        if (task->m_cancelled) {
+            return;
+        } else if (!ok) {
+            m_pending.removeOne(task);
+            emit task->failed(tr("Unable to write the image to upload"));
+            task->deleteLater();
+            return;
+        }
+        task->m_encoded = true;
+        schedule();
+    });
+    encoder->start(QThread::LowPriority);
+    return task;
+}
+
+void UploadQueue::schedule()
+{
+    // The captures are encoded in parallel, the first one ready goes first
+    for (int i = 0; i < m_pending.size() && m_running < MAX_RUNNING;) {
+        UploadTask* task = m_pending[i];
+        if (!task->m_encoded) {
+            ++i;
+            continue;
+        }
+        m_pending.removeAt(i);
+        ++m_running;
+        send(task);
+    }
+}
+
+void UploadQueue::send(UploadTask* task)
+{
+    ++task->m_attempt;
+    // The body is consumed by the request, each attempt needs its own
+    auto* multiPart = new QHttpMultiPart(QHttpMultiPart::FormDataType);
+    auto* body = new QFile(task->m_file->fileName(), multiPart);
+    if (!body->open(QIODevice::ReadOnly)) {
+        delete multiPart;
+        emit task->failed(tr("Unable to read the image to upload"));
+        finish(task);
+        return;
+    }
+    QHttpPart part;
+    part.setHeader(QNetworkRequest::ContentTypeHeader,
+                   QStringLiteral("image/png"));
+    part.setHeader(QNetworkRequest::ContentDispositionHeader,
+                   QStringLiteral("form-data; name=\"%1\"; filename=\"%2\"")
+                     .arg(task->m_field, QFileInfo(*body).fileName()));
+    part.setBodyDevice(body);
+    multiPart->append(part);
+
+    QNetworkReply* reply = m_network->post(task->m_request, multiPart);
+    multiPart->setParent(reply);
+    task->m_reply = reply;
+    connect(reply,
+            &QNetworkReply::uploadProgress,
+            task,
+            &UploadTask::progress);
+    connect(reply, &QNetworkReply::finished, this, [this, task, reply]() {
+        handleReply(task, reply);
+    });
+}
+
+void UploadQueue::handleReply(UploadTask* task, QNetworkReply* reply)
+{
+    task->m_reply = nullptr;
+    reply->deleteLater();
+    if (task->m_cancelled) {
+        finish(task);
+        return;
+    }
+    if (reply->error() != QNetworkReply::NoError && isTransient(reply) &&
+        task->m_attempt < MAX_ATTEMPTS) {
+        const int delay = RETRY_DELAY_MS << (task->m_attempt - 1);
+        Metrics::instance()->increment(QStringLiteral("uploadRetries"));
+        emit task->retrying(task->m_attempt, delay);
+        // The task keeps its place, the other uploads would likely fail too
+        QTimer::singleShot(delay, task, [this, task]() {
+            if (task->m_cancelled) {
+                finish(task);
+            } else {
+                send(task);
+            }
+        });
+        return;
+    }
+    emit task->finished(reply);
+    finish(task);
+}
+
+void UploadQueue::finish(UploadTask* task)
+{
+    --m_running;
+    task->deleteLater();
+    schedule();
+}
+
+void UploadQueue::cancel(UploadTask* task)
+{
+    if (task->m_cancelled) {
+        return;
+    }
+    task->m_cancelled = true;
+    if (m_pending.removeOne(task)) {
+        // Deleting the task waits for the encoder
+        task->deleteLater();
+    } else if (task->m_reply) {
+        // Finished by handleReply()
+        task->m_reply->abort();
+    }
+    // Otherwise the task is finished once its retry delay is over
+}
+
+// Errors likely gone on the next attempt
+bool UploadQueue::isTransient(QNetworkReply* reply)
+{
+    const int status =
+      reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (status == 429 || status >= 500) {
+        return true;
+    }
+    switch (reply->error()) {
+        case QNetworkReply::ConnectionRefusedError:
+        case QNetworkReply::RemoteHostClosedError:
+        case QNetworkReply::HostNotFoundError:
+        case QNetworkReply::TimeoutError:
+        case QNetworkReply::TemporaryNetworkFailureError:
+        case QNetworkReply::NetworkSessionFailedError:
+        case QNetworkReply::ProxyTimeoutError:
+        case QNetworkReply::UnknownNetworkError:
+            return true;
+        default:
+            return false;
+    }
+}
@@ -0,0 +1,92 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QImage>
+#include <QList>
+#include <QNetworkRequest>
+#include <QObject>
+#include <QPointer>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+class QTemporaryFile;
+class QThread;
+
+// Upload of a capture, made by the UploadQueue
+class UploadTask : public QObject
+{
+    Q_OBJECT
+public:
+    ~UploadTask() override;
+
+    // Stops the upload, nothing is emitted afterwards
+    void cancel();
+
+signals:
+    void progress(qint64 sent, qint64 total);
+    // The attempt failed, the next one is made in `delayMs`
+    void retrying(int attempt, int delayMs);
+    // The server answered, or the last attempt failed. The reply is deleted
+    // once the slots return.
+    void finished(QNetworkReply* reply);
+    // The capture couldn't be encoded
+    void failed(const QString& error);
+
+private:
+    explicit UploadTask(QObject* parent = nullptr);
+
+    QNetworkRequest m_request;
+    QString m_field;
+    QTemporaryFile* m_file;
+    // Writing m_file, until it's done
+    QThread* m_encoder;
+    QPointer<QNetworkReply> m_reply;
+    int m_attempt;
+    bool m_encoded;
+    bool m_cancelled;
+
+    friend class UploadQueue;
+};
+
+// Uploads the captures, at most MAX_RUNNING of them at once.
+//
+// A capture is encoded to a temporary PNG file by a background thread as
+// soon as it is queued, and the file is streamed as the body of a multipart
+// form, so the interface never waits for the encoding and the encoded image
+// is never held in memory. Attempts failing because of the network or of
+// an overloaded server are made again after a delay doubled each time.
+class UploadQueue : public QObject
+{
+    Q_OBJECT
+public:
+    static UploadQueue* instance();
+
+    // Posts a form to `request` with `image` as the `field` file
+    UploadTask* enqueue(const QNetworkRequest& request,
+                        const QString& field,
+                        const QImage& image);
+
+    static constexpr int MAX_RUNNING = 2;
+    static constexpr int MAX_ATTEMPTS = 4;
+    static constexpr int RETRY_DELAY_MS = 1000;
+
+private:
+    explicit UploadQueue(QObject* parent);
+
+    void schedule();
+    void send(UploadTask* task);
+    void handleReply(UploadTask* task, QNetworkReply* reply);
+    void finish(UploadTask* task);
+    void cancel(UploadTask* task);
+    static bool isTransient(QNetworkReply* reply);
+
+    QNetworkAccessManager* m_network;
+    // Tasks that didn't start, their capture may still be encoded
+    QList<UploadTask*> m_pending;
+    // Tasks sending their capture or waiting for their next attempt
+    int m_running;
+
+    friend class UploadTask;
+};
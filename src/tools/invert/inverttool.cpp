@@ -17,7 +17,7 @@ InvertTool::InvertTool(QObject* parent)
 QIcon InvertTool::icon(const QColor& background, bool inEditor) const
 {
     Q_UNUSED(inEditor)
-    return QIcon(iconPath(background) + "invert.svg");
+    return IconAtlas::icon(iconPath(background) + "invert.svg");
 }
 
 QString InvertTool::name() const
@@ -49,10 +49,15 @@ CaptureTool* InvertTool::copy(QObject* parent)
 
 void InvertTool::process(QPainter& painter, const QPixmap& pixmap)
 {
-    QRect selection = boundingRect().intersected(pixmap.rect());
+    // The painter is translated when only a part of the capture is rendered,
+    // so the pixmap is read through the same transformation
+    const QTransform& transform = painter.transform();
+    QRect selection = boundingRect().intersected(
+      transform.inverted().mapRect(pixmap.rect()));
+    QRect source = transform.mapRect(selection);
     auto pixelRatio = pixmap.devicePixelRatio();
-    QRect selectionScaled = QRect(selection.topLeft() * pixelRatio,
-                                  selection.bottomRight() * pixelRatio);
+    QRect selectionScaled = QRect(source.topLeft() * pixelRatio,
+                                  source.bottomRight() * pixelRatio);
 
     // Invert selection
     QPixmap inv = pixmap.copy(selectionScaled);
@@ -2,14 +2,15 @@
 // SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
 
 #include "applauncherwidget.h"
+#include "capturetempfile.h"
 #include "src/tools/launcher/launcheritemdelegate.h"
 #include "src/utils/confighandler.h"
-#include "src/utils/filenamehandler.h"
 #include "src/utils/globalvalues.h"
 #include "terminallauncher.h"
 #include <QCheckBox>
 #include <QDir>
 #include <QHBoxLayout>
+#include <QHash>
 #include <QKeyEvent>
 #include <QLineEdit>
 #include <QList>
@@ -20,6 +21,8 @@
 #include <QProcess>
 #include <QStandardPaths>
 #include <QTabWidget>
+#include <algorithm>
+#include <numeric>
 
 namespace {
 #if defined(Q_OS_WIN)
@@ -42,13 +45,15 @@ QMap<QString, QString> catIconNames(
 
 AppLauncherWidget::AppLauncherWidget(const QPixmap& p, QWidget* parent)
   : QWidget(parent)
-  , m_pixmap(p)
+  , m_captureFile(new CaptureTempFile(p, this))
 {
     setAttribute(Qt::WA_DeleteOnClose);
     setWindowIcon(QIcon(GlobalValues::iconPath()));
     setWindowTitle(tr("Open With"));
 
     m_keepOpen = ConfigHandler().keepOpenAppLauncher();
+    // The capture is written while an app is being picked
+    m_captureFile->start(QThread::LowPriority);
 
 #if defined(Q_OS_WIN)
     QDir userAppsFolder(
@@ -62,15 +67,22 @@ AppLauncherWidget::AppLauncherWidget(const QPixmap& p, QWidget* parent)
         m_parser.processDirectory(allUserAppsFolder);
     }
 #else
-    QString dirLocal = QDir::homePath() + "/.local/share/applications/";
-    QDir appsDirLocal(dirLocal);
-    m_parser.processDirectory(appsDirLocal);
-
-    QString dir = QStringLiteral("/usr/share/applications/");
-    QDir appsDir(dir);
-    m_parser.processDirectory(appsDir);
+    // The cached entries are shown right away, the lists are filled again
+    // if they were outdated
+    connect(&m_index,
+            &DesktopEntryIndex::updated,
+            this,
+            &AppLauncherWidget::appsUpdated);
+    m_index.load();
 #endif
 
+    m_tabWidget = new QTabWidget;
+    const int size = GlobalValues::buttonBaseSize();
+    m_tabWidget->setIconSize(QSize(size, size));
+    m_filterList = new QListWidget;
+    m_filterList->hide();
+    configureListView(m_filterList);
+
     initAppMap();
     initListWidget();
 
@@ -88,11 +100,6 @@ AppLauncherWidget::AppLauncherWidget(const QPixmap& p, QWidget* parent)
             &QLineEdit::textChanged,
             this,
             &AppLauncherWidget::searchChanged);
-    m_filterList = new QListWidget;
-    m_filterList->hide();
-    configureListView(m_filterList);
-    connect(
-      m_filterList, &QListWidget::clicked, this, &AppLauncherWidget::launch);
 
     m_layout = new QVBoxLayout(this);
     m_layout->addWidget(m_filterList);
@@ -105,15 +112,13 @@ AppLauncherWidget::AppLauncherWidget(const QPixmap& p, QWidget* parent)
 
 void AppLauncherWidget::launch(const QModelIndex& index)
 {
-    if (!QFileInfo(m_tempFile).isReadable()) {
-        m_tempFile =
-          FileNameHandler().properScreenshotPath(QDir::tempPath(), "png");
-        bool ok = m_pixmap.save(m_tempFile);
-        if (!ok) {
-            QMessageBox::about(
-              this, tr("Error"), tr("Unable to write in") + QDir::tempPath());
-            return;
-        }
+    QString tempFile = m_captureFile->path();
+    if (tempFile.isEmpty()) {
+        QMessageBox::about(this,
+                           tr("Error"),
+                           tr("Unable to write in") + " " +
+                             CaptureTempFile::directory());
+        return;
     }
     // Heuristically, if there is a % in the command we assume it is the file
     // name slot
@@ -131,11 +136,11 @@ void AppLauncherWidget::launch(const QModelIndex& index)
         // but that means we need to substitute IN the array not the string!
         for (auto& i : prog_args) {
             if (i.contains("%"))
-                i.replace(QRegExp("(\\%.)"), m_tempFile);
+                i.replace(QRegExp("(\\%.)"), tempFile);
         }
     } else {
         // we really should append the file name if there
-        prog_args.append(m_tempFile); // were no replacements
+        prog_args.append(tempFile); // were no replacements
     }
     QString app_name = prog_args.at(0);
     bool inTerminal =
@@ -147,7 +152,7 @@ void AppLauncherWidget::launch(const QModelIndex& index)
               this, tr("Error"), tr("Unable to launch in terminal."));
         }
     } else {
-        QFileInfo fi(m_tempFile);
+        QFileInfo fi(tempFile);
         QString workingDir = fi.absolutePath();
         prog_args.removeAt(0); // strip program name out
         QProcess::startDetached(app_name, prog_args, workingDir);
@@ -172,32 +177,34 @@ void AppLauncherWidget::searchChanged(const QString& text)
     } else {
         m_tabWidget->hide();
         m_filterList->show();
-        m_filterList->clear();
-        QRegExp regexp(text, Qt::CaseInsensitive, QRegExp::Wildcard);
-        QVector<DesktopAppData> apps;
-
-        for (auto const& i : catIconNames.toStdMap()) {
-            const QString& cat = i.first;
-            if (!m_appsMap.contains(cat)) {
-                continue;
-            }
-            const QVector<DesktopAppData>& appList = m_appsMap[cat];
-            for (const DesktopAppData& app : appList) {
-                if (!apps.contains(app) && (app.name.contains(regexp) ||
-                                            app.description.contains(regexp))) {
-                    apps.append(app);
-                }
-            }
+        // The filter list holds all the apps in the order of m_apps
+        QVector<int> matches = m_searchIndex.search(text);
+        for (int row = 0; row < m_filterList->count(); ++row) {
+            bool match =
+              std::binary_search(matches.constBegin(), matches.constEnd(), row);
+            m_filterList->setRowHidden(row, !match);
         }
-        addAppsToListWidget(m_filterList, apps);
     }
 }
 
+void AppLauncherWidget::appsUpdated()
+{
+    initAppMap();
+    initListWidget();
+    searchChanged(m_lineEdit->text());
+}
+
 void AppLauncherWidget::initListWidget()
 {
-    m_tabWidget = new QTabWidget;
-    const int size = GlobalValues::buttonBaseSize();
-    m_tabWidget->setIconSize(QSize(size, size));
+    while (m_tabWidget->count() > 0) {
+        QWidget* itemsWidget = m_tabWidget->widget(0);
+        m_tabWidget->removeTab(0);
+        delete itemsWidget;
+    }
+    m_filterList->clear();
+    QVector<int> allApps(m_apps.size());
+    std::iota(allApps.begin(), allApps.end(), 0);
+    addAppsToListWidget(m_filterList, allApps);
 
     for (auto const& i : catIconNames.toStdMap()) {
         const QString& cat = i.first;
@@ -210,8 +217,7 @@ void AppLauncherWidget::initListWidget()
         auto* itemsWidget = new QListWidget();
         configureListView(itemsWidget);
 
-        const QVector<DesktopAppData>& appList = m_appsMap[cat];
-        addAppsToListWidget(itemsWidget, appList);
+        addAppsToListWidget(itemsWidget, m_appsMap[cat]);
 
 #if defined(Q_OS_WIN)
         QColor background = this->palette().window().color();
@@ -245,7 +251,13 @@ void AppLauncherWidget::initAppMap()
                              "System",
                              "Utility" });
 
-    m_appsMap = m_parser.getAppsByCategory(categories);
+#if defined(Q_OS_WIN)
+    QMap<QString, QVector<DesktopAppData>> appsMap =
+      m_parser.getAppsByCategory(categories);
+#else
+    QMap<QString, QVector<DesktopAppData>> appsMap =
+      m_index.getAppsByCategory(categories);
+#endif
 
     // Unify multimedia.
     QVector<DesktopAppData> multimediaList;
@@ -253,19 +265,41 @@ void AppLauncherWidget::initAppMap()
     multimediaNames << QStringLiteral("AudioVideo") << QStringLiteral("Audio")
                     << QStringLiteral("Video");
     for (const QString& name : qAsConst(multimediaNames)) {
-        if (!m_appsMap.contains(name)) {
+        if (!appsMap.contains(name)) {
             continue;
         }
-        for (const auto& i : m_appsMap[name]) {
+        for (const auto& i : appsMap[name]) {
             if (!multimediaList.contains(i)) {
                 multimediaList.append(i);
             }
         }
-        m_appsMap.remove(name);
+        appsMap.remove(name);
     }
 
     if (!multimediaList.isEmpty()) {
-        m_appsMap.insert(QStringLiteral("Multimedia"), multimediaList);
+        appsMap.insert(QStringLiteral("Multimedia"), multimediaList);
+    }
+
+    // Store every app once, in the order of the tabs
+    m_apps.clear();
+    m_appsMap.clear();
+    m_searchIndex.clear();
+    QHash<QString, int> appIndexes;
+    for (auto const& i : catIconNames.toStdMap()) {
+        const QString& cat = i.first;
+        if (!appsMap.contains(cat)) {
+            continue;
+        }
+        QVector<int>& indexes = m_appsMap[cat];
+        for (const DesktopAppData& app : appsMap[cat]) {
+            // apps are identified by their name like in DesktopAppData
+            if (!appIndexes.contains(app.name)) {
+                appIndexes.insert(app.name, m_apps.size());
+                m_apps.append(app);
+                m_searchIndex.add({ app.name, app.description });
+            }
+            indexes.append(appIndexes.value(app.name));
+        }
     }
 }
 
@@ -281,21 +315,24 @@ void AppLauncherWidget::configureListView(QListWidget* widget)
     connect(widget, &QListWidget::clicked, this, &AppLauncherWidget::launch);
 }
 
-void AppLauncherWidget::addAppsToListWidget(
-  QListWidget* widget,
-  const QVector<DesktopAppData>& appList)
+void AppLauncherWidget::addAppsToListWidget(QListWidget* widget,
+                                            const QVector<int>& appList)
 {
-    for (const DesktopAppData& app : appList) {
+    for (int index : appList) {
+        const DesktopAppData& app = m_apps.at(index);
         auto* buttonItem = new QListWidgetItem(widget);
-        buttonItem->setData(Qt::DecorationRole, app.icon);
         buttonItem->setData(Qt::DisplayRole, app.name);
         buttonItem->setData(Qt::UserRole, app.exec);
         buttonItem->setData(Qt::UserRole + 1, app.showInTerminal);
+        // Theme icons are looked up by the delegate once they are painted
+        buttonItem->setData(Qt::UserRole + 2, app.iconName);
         QColor foregroundColor =
           this->palette().color(QWidget::foregroundRole());
         buttonItem->setForeground(foregroundColor);
 
-        buttonItem->setIcon(app.icon);
+        if (!app.icon.isNull()) {
+            buttonItem->setIcon(app.icon);
+        }
         buttonItem->setText(app.name);
         buttonItem->setToolTip(app.description);
     }
@@ -310,8 +347,17 @@ void AppLauncherWidget::keyPressEvent(QKeyEvent* keyEvent)
         if (m_filterList->isVisible())
             widget = m_filterList;
         auto* item = widget->currentItem();
-        if (item == nullptr) {
-            item = widget->item(0);
+        if (item == nullptr || item->isHidden()) {
+            // first app left by the search
+            item = nullptr;
+            for (int row = 0; row < widget->count() && item == nullptr; ++row) {
+                if (!widget->isRowHidden(row)) {
+                    item = widget->item(row);
+                }
+            }
+            if (item == nullptr) {
+                return;
+            }
             widget->setCurrentItem(item);
         }
         QModelIndex const idx = widget->currentIndex();
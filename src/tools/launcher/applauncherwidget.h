@@ -6,12 +6,15 @@
 #include <QMap>
 #include <QWidget>
 
+#include "src/utils/trigramindex.h"
+
 #if defined(Q_OS_WIN)
 #include "src/utils/winlnkfileparse.h"
 #else
-#include "src/utils/desktopfileparse.h"
+#include "src/utils/desktopentryindex.h"
 #endif
 
+class CaptureTempFile;
 class QTabWidget;
 class QCheckBox;
 class QVBoxLayout;
@@ -28,24 +31,27 @@ private slots:
     void launch(const QModelIndex& index);
     void checkboxClicked(const bool enabled);
     void searchChanged(const QString& text);
+    void appsUpdated();
 
 private:
     void initListWidget();
     void initAppMap();
     void configureListView(QListWidget* widget);
-    void addAppsToListWidget(QListWidget* widget,
-                             const QVector<DesktopAppData>& appList);
+    void addAppsToListWidget(QListWidget* widget, const QVector<int>& appList);
     void keyPressEvent(QKeyEvent* keyEvent) override;
 
 #if defined(Q_OS_WIN)
     WinLnkFileParser m_parser;
 #else
-    DesktopFileParser m_parser;
+    DesktopEntryIndex m_index;
 #endif
-    QPixmap m_pixmap;
-    QString m_tempFile;
+    CaptureTempFile* m_captureFile;
     bool m_keepOpen;
-    QMap<QString, QVector<DesktopAppData>> m_appsMap;
+    // Applications of all the categories, without duplicates
+    QVector<DesktopAppData> m_apps;
+    // Indexes in m_apps of the applications of each category
+    QMap<QString, QVector<int>> m_appsMap;
+    TrigramIndex m_searchIndex;
     QCheckBox* m_keepOpenCheckbox;
     QCheckBox* m_terminalCheckbox;
     QVBoxLayout* m_layout;
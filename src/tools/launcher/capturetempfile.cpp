@@ -0,0 +1,78 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "capturetempfile.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QPixmap>
+#include <QStandardPaths>
+#include <QTemporaryFile>
+
+namespace {
+constexpr qint64 STALE_AGE_SECS = 60 * 60;
+}
+
+CaptureTempFile::CaptureTempFile(const QPixmap& capture, QObject* parent)
+  : QThread(parent)
+  , m_image(capture.toImage())
+{}
+
+CaptureTempFile::~CaptureTempFile()
+{
+    wait();
+}
+
+QString CaptureTempFile::path()
+{
+    wait();
+    if (m_path.isEmpty() || !QFileInfo(m_path).isReadable()) {
+        run();
+    }
+    return m_path;
+}
+
+QString CaptureTempFile::directory()
+{
+    QString dir;
+#if defined(Q_OS_LINUX)
+    dir = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+#endif
+    if (dir.isEmpty() || !QFileInfo(dir).isWritable()) {
+        dir = QDir::tempPath();
+    }
+    return dir;
+}
+
+void CaptureTempFile::removeStale()
+{
+    const QDateTime staleBefore =
+      QDateTime::currentDateTime().addSecs(-STALE_AGE_SECS);
+    // The names picked by QTemporaryFile in run()
+    const QStringList pattern{ QStringLiteral("flameshot-??????.png") };
+    const QFileInfoList files =
+      QDir(directory()).entryInfoList(pattern, QDir::Files);
+    for (const QFileInfo& file : files) {
+        if (file.lastModified() < staleBefore) {
+            QFile::remove(file.filePath());
+        }
+    }
+}
+
+void CaptureTempFile::run()
+{
+    removeStale();
+    // No need to look for an unused name, it's picked atomically
+    QTemporaryFile file(directory() + "/flameshot-XXXXXX.png");
+    // The file has to stay for the launched applications
+    file.setAutoRemove(false);
+    m_path.clear();
+    if (!file.open()) {
+        return;
+    }
+    if (!m_image.save(&file, "PNG")) {
+        file.remove();
+        return;
+    }
+    m_path = file.fileName();
+}
@@ -0,0 +1,42 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QImage>
+#include <QThread>
+
+class QPixmap;
+
+// PNG file of a capture, used to hand the capture to other applications.
+//
+// The file is created with a unique name in the runtime directory when there
+// is one (a tmpfs on most systems) or in the temporary directory otherwise.
+// start() encodes it in the background, the same file is used for all the
+// applications the capture is opened with. The file is left for them once
+// the capture is closed, and removed by removeStale() later on.
+class CaptureTempFile : public QThread
+{
+public:
+    explicit CaptureTempFile(const QPixmap& capture,
+                             QObject* parent = nullptr);
+    ~CaptureTempFile() override;
+
+    // Path of the file, waiting for it to be written. The file is written
+    // again if it was removed in the meantime. Empty if it couldn't be
+    // written.
+    QString path();
+
+    // Directory the files are written to
+    static QString directory();
+    // Remove the files written more than an hour ago, the applications they
+    // were opened with are done with them
+    static void removeStale();
+
+protected:
+    void run() override;
+
+private:
+    QImage m_image;
+    QString m_path;
+};
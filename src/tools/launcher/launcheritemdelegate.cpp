@@ -3,8 +3,26 @@
 
 #include "launcheritemdelegate.h"
 #include "src/utils/globalvalues.h"
+#include <QHash>
 #include <QPainter>
 
+namespace {
+// Theme icons are looked up once for all the launchers
+QIcon themeIcon(const QString& name)
+{
+    static QHash<QString, QIcon> icons;
+    auto it = icons.constFind(name);
+    if (it != icons.constEnd()) {
+        return it.value();
+    }
+    static const QIcon defaultIcon =
+      QIcon::fromTheme(QStringLiteral("application-x-executable"));
+    QIcon icon = QIcon::fromTheme(name, defaultIcon);
+    icons.insert(name, icon);
+    return icon;
+}
+}
+
 LauncherItemDelegate::LauncherItemDelegate(QObject* parent)
   : QStyledItemDelegate(parent)
 {}
@@ -23,6 +41,9 @@ void LauncherItemDelegate::paint(QPainter* painter,
         painter->restore();
     }
     auto icon = index.data(Qt::DecorationRole).value<QIcon>();
+    if (icon.isNull()) {
+        icon = themeIcon(index.data(Qt::UserRole + 2).toString());
+    }
 
     const int iconSide = static_cast<int>(GlobalValues::buttonBaseSize() * 1.3);
     const int halfIcon = iconSide / 2;
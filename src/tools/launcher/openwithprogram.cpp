@@ -4,8 +4,7 @@
 #include "openwithprogram.h"
 
 #if defined(Q_OS_WIN)
-#include "src/utils/filenamehandler.h"
-#include <QDir>
+#include "src/tools/launcher/capturetempfile.h"
 #include <QMessageBox>
 #include <windows.h>
 #ifdef _WIN32_WINNT
@@ -22,14 +21,12 @@
 void showOpenWithMenu(const QPixmap& capture)
 {
 #if defined(Q_OS_WIN)
-    QString tempFile =
-      FileNameHandler().properScreenshotPath(QDir::tempPath(), "png");
-    bool ok = capture.save(tempFile);
-    if (!ok) {
+    QString tempFile = CaptureTempFile(capture).path();
+    if (tempFile.isEmpty()) {
         QMessageBox::about(nullptr,
                            QObject::tr("Error"),
-                           QObject::tr("Unable to write in") +
-                             QDir::tempPath());
+                           QObject::tr("Unable to write in") + " " +
+                             CaptureTempFile::directory());
         return;
     }
 
@@ -16,7 +16,7 @@ MarkerTool::MarkerTool(QObject* parent)
 QIcon MarkerTool::icon(const QColor& background, bool inEditor) const
 {
     Q_UNUSED(inEditor)
-    return QIcon(iconPath(background) + "marker.svg");
+    return IconAtlas::icon(iconPath(background) + "marker.svg");
 }
 QString MarkerTool::name() const
 {
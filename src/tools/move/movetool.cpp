@@ -16,7 +16,7 @@ bool MoveTool::closeOnButtonPressed() const
 QIcon MoveTool::icon(const QColor& background, bool inEditor) const
 {
     Q_UNUSED(inEditor)
-    return QIcon(iconPath(background) + "cursor-move.svg");
+    return IconAtlas::icon(iconPath(background) + "cursor-move.svg");
 }
 QString MoveTool::name() const
 {
@@ -18,7 +18,7 @@ bool PinTool::closeOnButtonPressed() const
 QIcon PinTool::icon(const QColor& background, bool inEditor) const
 {
     Q_UNUSED(inEditor)
-    return QIcon(iconPath(background) + "pin.svg");
+    return IconAtlas::icon(iconPath(background) + "pin.svg");
 }
 QString PinTool::name() const
 {
@@ -1,22 +1,30 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 // SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
-#include <QGraphicsDropShadowEffect>
 #include <QGraphicsOpacityEffect>
 #include <QPinchGesture>
 
 #include "pinwidget.h"
 #include "screenshotsaver.h"
+#include "src/config/cacheutils.h"
 #include "src/utils/confighandler.h"
 #include "src/utils/globalvalues.h"
 
+#include <QBuffer>
+#include <QDateTime>
+#include <QHash>
 #include <QLabel>
 #include <QMenu>
+#include <QPainter>
 #include <QScreen>
 #include <QShortcut>
+#include <QTemporaryFile>
+#include <QThread>
+#include <QTimer>
 #include <QVBoxLayout>
 #include <QWheelEvent>
 #include <flameshot.h>
 #include <flameshotdaemon.h>
+#include <qdrawutil.h>
 #ifdef Q_OS_WIN
 #include <windows.h>
 #endif
@@ -24,10 +32,113 @@
 namespace {
 constexpr int MARGIN = 7;
 constexpr int BLUR_RADIUS = 2 * MARGIN;
+// Three box blurs of half the radius of QGraphicsDropShadowEffect are close
+// enough to its gaussian blur
+constexpr int BOX_BLUR_RADIUS = BLUR_RADIUS / 2;
+constexpr int BLUR_REACH = 3 * BOX_BLUR_RADIUS;
+// Width of the border slices of the shadow texture, they go as far under the
+// pin as the blur reaches so the edge looks the same for any pin size
+constexpr int SHADOW_SLICE = MARGIN + BLUR_REACH;
 constexpr qreal SCALING_STEP = 0.025;
 constexpr qreal OPACITY_WHEEL_STEP = 0.02;
 constexpr qreal OPACITY_STEP = 0.1;
 constexpr qreal MIN_SIZE = 100.0;
+constexpr int REFINE_DELAY = 150;
+// PNG compression level (100 - 75) * 9 / 91 = 2, the spill file only has to
+// be much smaller than the pixels
+constexpr int SPILL_QUALITY = 75;
+
+qint64 pixmapBytes(const QPixmap& pixmap)
+{
+    return static_cast<qint64>(pixmap.width()) * pixmap.height() *
+           pixmap.depth() / 8;
+}
+
+void boxBlur(QVector<int>& alpha, int size, int radius, bool horizontal)
+{
+    QVector<int> line(size);
+    for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
+            line[j] = horizontal ? alpha[i * size + j] : alpha[j * size + i];
+        }
+        for (int j = 0; j < size; ++j) {
+            int sum = 0;
+            for (int k = j - radius; k <= j + radius; ++k) {
+                sum += (k >= 0 && k < size) ? line[k] : 0;
+            }
+            int& value = horizontal ? alpha[i * size + j] : alpha[j * size + i];
+            value = sum / (2 * radius + 1);
+        }
+    }
+}
+
+// Nine-slice texture of the shadow around a pin, the center pixel is the
+// area covered by the screenshot. It is only made once per color and shared
+// by all the pins instead of blurring every pin on each repaint.
+QPixmap shadowTexture(const QColor& color)
+{
+    static QHash<QRgb, QPixmap> textures;
+    auto it = textures.constFind(color.rgba());
+    if (it != textures.constEnd()) {
+        return it.value();
+    }
+    const int size = 2 * SHADOW_SLICE + 1;
+    // The blur is made with room around the texture, the pixels it spreads
+    // out of it on one pass are needed by the next ones
+    const int canvas = size + 2 * BLUR_REACH;
+    const int inset = BLUR_REACH + MARGIN;
+    QVector<int> alpha(canvas * canvas, 0);
+    for (int y = inset; y < canvas - inset; ++y) {
+        for (int x = inset; x < canvas - inset; ++x) {
+            alpha[y * canvas + x] = 255;
+        }
+    }
+    for (int pass = 0; pass < 3; ++pass) {
+        boxBlur(alpha, canvas, BOX_BLUR_RADIUS, true);
+        boxBlur(alpha, canvas, BOX_BLUR_RADIUS, false);
+    }
+    QImage image(size, size, QImage::Format_ARGB32_Premultiplied);
+    for (int y = 0; y < size; ++y) {
+        auto* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+        for (int x = 0; x < size; ++x) {
+            int a = alpha[(y + BLUR_REACH) * canvas + x + BLUR_REACH] *
+                    color.alpha() / 255;
+            line[x] = qPremultiply(
+              qRgba(color.red(), color.green(), color.blue(), a));
+        }
+    }
+    QPixmap texture = QPixmap::fromImage(image);
+    textures.insert(color.rgba(), texture);
+    return texture;
+}
+
+// Encodes the original of a pin being compacted off the GUI thread, a 4K
+// pin takes long enough to freeze all the pins
+class SpillEncoder : public QThread
+{
+public:
+    SpillEncoder(QImage image, QObject* parent)
+      : QThread(parent)
+      , m_image(std::move(image))
+    {}
+    ~SpillEncoder() override { wait(); }
+
+    QByteArray data;
+
+protected:
+    void run() override
+    {
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly);
+        if (!m_image.save(&buffer, "PNG", SPILL_QUALITY)) {
+            data.clear();
+        }
+        m_image = QImage();
+    }
+
+private:
+    QImage m_image;
+};
 }
 
 PinWidget::PinWidget(const QPixmap& pixmap,
@@ -37,7 +148,7 @@ PinWidget::PinWidget(const QPixmap& pixmap,
   , m_pixmap(pixmap)
   , m_layout(new QVBoxLayout(this))
   , m_label(new QLabel())
-  , m_shadowEffect(nullptr)
+  , m_refineTimer(new QTimer(this))
 {
     setWindowIcon(QIcon(GlobalValues::iconPath()));
     setWindowFlags(Qt::WindowStaysOnTopHint | Qt::FramelessWindowHint);
@@ -54,8 +165,18 @@ PinWidget::PinWidget(const QPixmap& pixmap,
     setArgs(args);
     setWindowOpacity(m_opacity);
 
-    m_label->setPixmap(m_pixmap);
+    setDisplayPixmap(m_pixmap);
     m_layout->addWidget(m_label);
+    touch();
+    m_zoomCache.setSource(m_pixmap);
+
+    m_refineTimer->setSingleShot(true);
+    m_refineTimer->setInterval(REFINE_DELAY);
+    connect(m_refineTimer, &QTimer::timeout, this, [this]() {
+        m_fastZoom = false;
+        m_sizeChanged = true;
+        update();
+    });
 
     new QShortcut(QKeySequence(Qt::CTRL + Qt::Key_Q), this, SLOT(close()));
     new QShortcut(Qt::Key_Escape, this, SLOT(close()));
@@ -154,6 +275,9 @@ bool PinWidget::scrollEvent(QWheelEvent* e)
             ? m_currentStepScaleFactor + SCALING_STEP
             : m_currentStepScaleFactor - SCALING_STEP;
         m_expanding = m_currentStepScaleFactor >= 1.0;
+        // Some platforms never send the end of the scroll
+        m_fastZoom = true;
+        m_refineTimer->start();
     }
 #if defined(Q_OS_MACOS)
     // ScrollEnd is currently supported only on Mac OSX
@@ -164,6 +288,7 @@ bool PinWidget::scrollEvent(QWheelEvent* e)
         m_scaleFactor *= m_currentStepScaleFactor;
         m_currentStepScaleFactor = 1.0;
         m_expanding = false;
+        m_fastZoom = false;
     }
 
     m_sizeChanged = true;
@@ -175,12 +300,14 @@ bool PinWidget::scrollEvent(QWheelEvent* e)
 
 void PinWidget::enterEvent(QEvent*)
 {
-    if(m_shadowEffect) m_shadowEffect->setColor(m_hoverColor);
+    m_hovered = true;
+    if (m_shadow) update();
 }
 
 void PinWidget::leaveEvent(QEvent*)
 {
-    if(m_shadowEffect) m_shadowEffect->setColor(m_baseColor);
+    m_hovered = false;
+    if (m_shadow) update();
 }
 
 void PinWidget::mouseDoubleClickEvent(QMouseEvent*)
@@ -190,6 +317,7 @@ void PinWidget::mouseDoubleClickEvent(QMouseEvent*)
 
 void PinWidget::mousePressEvent(QMouseEvent* e)
 {
+    touch();
     m_dragStart = e->globalPos();
     m_offsetX = e->localPos().x() / width();
     m_offsetY = e->localPos().y() / height();
@@ -243,18 +371,155 @@ void PinWidget::applyOpacity()
 
 void PinWidget::setShadowEffect(bool on)
 {
-    if (on) {
-        if (m_shadowEffect != nullptr)
-            return;
-        m_shadowEffect = new QGraphicsDropShadowEffect(this);
-        m_shadowEffect->setColor(m_baseColor);
-        m_shadowEffect->setBlurRadius(BLUR_RADIUS);
-        m_shadowEffect->setOffset(0, 0);
-        setGraphicsEffect(m_shadowEffect);
+    m_shadow = on;
+    update();
+}
+
+void PinWidget::transformPixmap(const QTransform& transform)
+{
+    m_pixmap = pixmap().transformed(transform);
+    m_zoomCache.setSource(m_pixmap);
+    // the spilled original is outdated
+    delete m_spillFile;
+    m_spillFile = nullptr;
+    m_sizeChanged = true;
+    update();
+}
+
+void PinWidget::setDisplayPixmap(const QPixmap& pixmap)
+{
+    if (pixmap.cacheKey() != m_displayPixmap.cacheKey()) {
+        m_displayIsOriginal =
+          !m_pixmap.isNull() && pixmap.cacheKey() == m_pixmap.cacheKey();
     }
-    else {
-        setGraphicsEffect(m_shadowEffect = nullptr);
+    m_displayPixmap = pixmap;
+    m_label->setPixmap(pixmap);
+}
+
+const QPixmap& PinWidget::pixmap()
+{
+    touch();
+    if (!m_compacted) {
+        return m_pixmap;
+    }
+    bool ok = false;
+    const qint64 size = m_spillFile->size();
+    // Decode straight from the mapped file, without reading it in a buffer
+    if (uchar* data = m_spillFile->map(0, size)) {
+        ok = m_pixmap.loadFromData(data, size, "PNG");
+        m_spillFile->unmap(data);
+    } else if (m_spillFile->seek(0)) {
+        ok = m_pixmap.loadFromData(m_spillFile->readAll(), "PNG");
+    }
+    if (!ok) {
+        // Better than nothing
+        m_pixmap = m_displayPixmap.scaled(m_originalSize,
+                                          Qt::IgnoreAspectRatio,
+                                          Qt::SmoothTransformation);
+    }
+    m_pixmap.setDevicePixelRatio(m_originalDevicePixelRatio);
+    m_compacted = false;
+    if (m_displayPixmap.size() == m_pixmap.size()) {
+        // Share the pixels instead of keeping two copies of them
+        setDisplayPixmap(m_pixmap);
+    }
+    m_zoomCache.setSource(m_pixmap);
+    emit originalRestored();
+    return m_pixmap;
+}
+
+// Decoding the original takes a while, it is never done while painting
+void PinWidget::restoreLater()
+{
+    if (m_restoreQueued) {
+        return;
+    }
+    m_restoreQueued = true;
+    QMetaObject::invokeMethod(
+      this,
+      [this]() {
+          m_restoreQueued = false;
+          if (m_compacted) {
+              pixmap();
+              m_sizeChanged = true;
+              update();
+          }
+      },
+      Qt::QueuedConnection);
+}
+
+void PinWidget::touch()
+{
+    m_lastUsed = QDateTime::currentMSecsSinceEpoch();
+}
+
+qint64 PinWidget::memoryUsage() const
+{
+    if (m_compacted || m_spillEncoder != nullptr) {
+        // the original being encoded is about to be dropped too
+        return pixmapBytes(m_displayPixmap);
+    }
+    qint64 bytes = m_zoomCache.memoryUsage() + pixmapBytes(m_pixmap);
+    if (m_displayPixmap.cacheKey() != m_pixmap.cacheKey()) {
+        bytes += pixmapBytes(m_displayPixmap);
+    }
+    return bytes;
+}
+
+void PinWidget::compact()
+{
+    if (m_compacted || m_spillEncoder != nullptr || m_displayIsOriginal) {
+        return;
+    }
+    if (m_spillFile != nullptr) {
+        dropOriginal();
+        return;
+    }
+    auto* encoder = new SpillEncoder(m_pixmap.toImage(), this);
+    const qint64 cacheKey = m_pixmap.cacheKey();
+    connect(encoder, &QThread::finished, this, [this, encoder, cacheKey]() {
+        spillFinished(encoder, cacheKey);
+    });
+    m_spillEncoder = encoder;
+    encoder->start();
+}
+
+void PinWidget::spillFinished(QThread* encoder, qint64 cacheKey)
+{
+    m_spillEncoder = nullptr;
+    encoder->deleteLater();
+    const QByteArray& data = static_cast<SpillEncoder*>(encoder)->data;
+    // The pin may have been rotated or shown at full resolution meanwhile
+    if (data.isEmpty() || m_pixmap.cacheKey() != cacheKey ||
+        m_displayIsOriginal) {
+        return;
     }
+    auto* file = new QTemporaryFile(getCachePath() + "/pin-XXXXXX.png", this);
+    if (!file->open() || file->write(data) != data.size() || !file->flush()) {
+        delete file;
+        return;
+    }
+    m_spillFile = file;
+    dropOriginal();
+}
+
+void PinWidget::dropOriginal()
+{
+    m_originalSize = m_pixmap.size();
+    m_originalDevicePixelRatio = m_pixmap.devicePixelRatio();
+    m_pixmap = QPixmap();
+    m_zoomCache.clear();
+    m_compacted = true;
+}
+
+bool PinWidget::isCompacted() const
+{
+    return m_compacted;
+}
+
+qint64 PinWidget::lastUsed() const
+{
+    return m_lastUsed;
 }
 
 void PinWidget::setArgs(const QByteArray& args)
@@ -284,7 +549,7 @@ QByteArray PinWidget::packArgs()
         << m_scaleFactor
         << m_opacity
         << m_currentStepScaleFactor
-        << bool(m_shadowEffect != nullptr);
+        << m_shadow;
     return args;
 }
 
@@ -303,11 +568,13 @@ void PinWidget::paintEvent(QPaintEvent* event)
     if (m_sizeChanged) {
         const auto aspectRatio =
           m_expanding ? Qt::KeepAspectRatioByExpanding : Qt::KeepAspectRatio;
-        const auto transformType = ConfigHandler().antialiasingPinZoom()
-                                     ? Qt::SmoothTransformation
-                                     : Qt::FastTransformation;
-        const qreal iw = m_pixmap.width();
-        const qreal ih = m_pixmap.height();
+        const auto transformType =
+          ConfigHandler().antialiasingPinZoom() && !m_fastZoom
+            ? Qt::SmoothTransformation
+            : Qt::FastTransformation;
+        const QSize original = m_compacted ? m_originalSize : m_pixmap.size();
+        const qreal iw = original.width();
+        const qreal ih = original.height();
         const qreal nw = qBound(MIN_SIZE,
                                 iw * m_currentStepScaleFactor * m_scaleFactor,
                                 static_cast<qreal>(maximumWidth()));
@@ -315,12 +582,33 @@ void PinWidget::paintEvent(QPaintEvent* event)
                                 ih * m_currentStepScaleFactor * m_scaleFactor,
                                 static_cast<qreal>(maximumHeight()));
 
-        const QPixmap pix = m_pixmap.scaled(nw, nh, aspectRatio, transformType);
+        QPixmap pix;
+        if (m_compacted) {
+            // Scale what is shown until the original is restored
+            const QSize target = original.scaled(QSize(nw, nh), aspectRatio);
+            pix = m_displayPixmap.scaled(
+              target, Qt::IgnoreAspectRatio, Qt::FastTransformation);
+            if (target != m_displayPixmap.size()) {
+                restoreLater();
+            }
+        } else {
+            pix = m_zoomCache.scaled(QSize(nw, nh), aspectRatio, transformType);
+        }
 
-        m_label->setPixmap(pix);
+        setDisplayPixmap(pix);
         adjustSize();
         m_sizeChanged = false;
     }
+    if (m_shadow) {
+        QPainter painter(this);
+        const QRect shadowRect =
+          m_label->geometry() + QMargins(MARGIN, MARGIN, MARGIN, MARGIN);
+        const int slice = SHADOW_SLICE;
+        qDrawBorderPixmap(&painter,
+                          shadowRect,
+                          QMargins(slice, slice, slice, slice),
+                          shadowTexture(m_hovered ? m_hoverColor : m_baseColor));
+    }
 }
 
 void PinWidget::pinchTriggered(QPinchGesture* gesture)
@@ -334,6 +622,10 @@ void PinWidget::pinchTriggered(QPinchGesture* gesture)
         m_scaleFactor *= m_currentStepScaleFactor;
         m_currentStepScaleFactor = 1;
         m_expanding = false;
+        m_fastZoom = false;
+    } else {
+        m_fastZoom = true;
+        m_refineTimer->start();
     }
     m_sizeChanged = true;
     update();
@@ -347,7 +639,7 @@ void PinWidget::showContextMenu(const QPoint& pos)
     connect(&copyToClipboardAction,
             &QAction::triggered,
             this,
-            [=](){ saveToClipboard(m_pixmap); });
+            [=](){ saveToClipboard(pixmap()); });
 
     QAction saveToFileAction(tr("&Save to file"), this);
     connect(
@@ -360,7 +652,7 @@ void PinWidget::showContextMenu(const QPoint& pos)
         [=]() {
             const auto fd = FlameshotDaemon::instance();
             fd->attachPin(
-                m_pixmap,
+                pixmap(),
                 geometry() - layout()->contentsMargins(),
                 packArgs());
             fd->showFloatingText(tr("Pin cloning completed"));
@@ -433,40 +725,22 @@ void PinWidget::showContextMenu(const QPoint& pos)
     connect(&rotateRightAction,
         &QAction::triggered,
         this,
-        [=]() {
-            m_sizeChanged = true;
-            auto rotateTransform = QTransform().rotate(90);
-            m_pixmap = m_pixmap.transformed(rotateTransform);
-        });
+        [=]() { transformPixmap(QTransform().rotate(90)); });
     QAction rotateLeftAction(tr("Rotate &Left"), this);
     connect(&rotateLeftAction,
         &QAction::triggered,
         this,
-        [=]() {
-            m_sizeChanged = true;
-            auto rotateTransform = QTransform().rotate(270);
-            m_pixmap = m_pixmap.transformed(rotateTransform);
-        });
+        [=]() { transformPixmap(QTransform().rotate(270)); });
     QAction horizontalMirroringAction(tr("&Horizontal mirroring"), this);
     connect(&horizontalMirroringAction,
         &QAction::triggered,
         this,
-        [=]() {
-            m_sizeChanged = true;
-            auto flipTransform = QTransform().scale(-1, 1);
-            m_pixmap = m_pixmap.transformed(flipTransform);
-            update();
-        });
+        [=]() { transformPixmap(QTransform().scale(-1, 1)); });
     QAction verticalMirroringAction(tr("&Vertical mirroring"), this);
     connect(&verticalMirroringAction,
         &QAction::triggered,
         this,
-        [=]() {
-            m_sizeChanged = true;
-            auto flipTransform = QTransform().scale(1, -1);
-            m_pixmap = m_pixmap.transformed(flipTransform);
-            update();
-        });
+        [=]() { transformPixmap(QTransform().scale(1, -1)); });
     imageTransformSubMenu.addAction(&rotateRightAction);
     imageTransformSubMenu.addAction(&rotateLeftAction);
     imageTransformSubMenu.addAction(&horizontalMirroringAction);
@@ -506,21 +780,11 @@ void PinWidget::showContextMenu(const QPoint& pos)
 
     QAction windowShadowAction(tr("&Window Shadow"), this);
     windowShadowAction.setCheckable(true);
-    windowShadowAction.setChecked(m_shadowEffect != nullptr);
+    windowShadowAction.setChecked(m_shadow);
     connect(&windowShadowAction,
         &QAction::triggered,
         this,
-        [=]() {
-            if (m_shadowEffect == nullptr)
-            {
-                hide();
-                setShadowEffect(true);
-                show();
-            }
-            else {
-                setShadowEffect(false);
-            }
-        });
+        [=]() { setShadowEffect(!m_shadow); });
 
 #ifdef Q_OS_WIN
     QAction windowOnTopAction(tr("Window on &Top"), this);
@@ -577,7 +841,7 @@ void PinWidget::showContextMenu(const QPoint& pos)
 void PinWidget::saveToFile()
 {
     hide();
-    saveToFilesystemGUI(m_pixmap);
+    saveToFilesystemGUI(pixmap());
     show();
 }
 
@@ -597,7 +861,7 @@ void PinWidget::setMouseTransparent(bool on)
             return;
         m_mouseTrans = false;
         FlameshotDaemon::instance()->
-            attachPin(m_pixmap,
+            attachPin(pixmap(),
                 geometry() - layout()->contentsMargins(),
                 packArgs());
         close();
@@ -3,13 +3,16 @@
 
 #pragma once
 
+#include "pinzoomcache.h"
 #include <QWidget>
 
 class QLabel;
 class QVBoxLayout;
 class QGestureEvent;
 class QPinchGesture;
-class QGraphicsDropShadowEffect;
+class QTemporaryFile;
+class QThread;
+class QTimer;
 
 class PinWidget : public QWidget
 {
@@ -21,6 +24,20 @@ public:
     void setMouseTransparent(bool on);
     bool isMouseTransparent() const;
 
+    // Bytes used by the pixmaps of the pin
+    qint64 memoryUsage() const;
+    // Drop the full resolution pixmap, only the displayed copy stays in
+    // memory. The original is encoded to a compressed file in the
+    // background and read back when it's needed again. Pins shown at full
+    // resolution are left alone, their pixels are on screen anyway.
+    void compact();
+    bool isCompacted() const;
+    // Last time the pin was used, in ms since epoch
+    qint64 lastUsed() const;
+
+signals:
+    void originalRestored();
+
 protected:
     void mouseDoubleClickEvent(QMouseEvent*) override;
     void mousePressEvent(QMouseEvent*) override;
@@ -41,15 +58,40 @@ private:
     void applyOpacity();
     void setArgs(const QByteArray& args);
     void setShadowEffect(bool on);
+    void transformPixmap(const QTransform& transform);
+    void setDisplayPixmap(const QPixmap& pixmap);
+    const QPixmap& pixmap();
+    void restoreLater();
+    void spillFinished(QThread* encoder, qint64 cacheKey);
+    void dropOriginal();
+    void touch();
     QByteArray packArgs();
 
     QPixmap m_pixmap;
+    QPixmap m_displayPixmap;
+    // set while m_pixmap only lives in m_spillFile
+    bool m_compacted{ false };
+    // m_displayPixmap is the original itself, shown at full resolution
+    bool m_displayIsOriginal{ false };
+    bool m_restoreQueued{ false };
+    QSize m_originalSize;
+    qreal m_originalDevicePixelRatio{ 1 };
+    QTemporaryFile* m_spillFile{ nullptr };
+    // encoding m_pixmap for m_spillFile
+    QThread* m_spillEncoder{ nullptr };
+    qint64 m_lastUsed{ 0 };
     QVBoxLayout* m_layout;
     QLabel* m_label;
     QPoint m_dragStart;
     qreal m_offsetX{}, m_offsetY{};
-    QGraphicsDropShadowEffect* m_shadowEffect;
+    bool m_shadow{ false };
+    bool m_hovered{ false };
     QColor m_baseColor, m_hoverColor;
+    PinZoomCache m_zoomCache;
+    // Fast scaling is used while zooming, the pin is scaled smoothly again
+    // once the zoom gesture is over
+    bool m_fastZoom{ false };
+    QTimer* m_refineTimer;
 
     bool m_expanding{ false };
     qreal m_scaleFactor{ 1 };
@@ -0,0 +1,65 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "pinzoomcache.h"
+
+void PinZoomCache::setSource(const QPixmap& pixmap)
+{
+    clear();
+    m_levels << pixmap;
+}
+
+void PinZoomCache::clear()
+{
+    m_levels.clear();
+    m_lastScaled = QPixmap();
+}
+
+QPixmap PinZoomCache::scaled(const QSize& size,
+                             Qt::AspectRatioMode aspectRatioMode,
+                             Qt::TransformationMode transformMode)
+{
+    if (m_levels.isEmpty()) {
+        return {};
+    }
+    QSize target = m_levels.first().size().scaled(size, aspectRatioMode);
+    if (!m_lastScaled.isNull() && m_lastScaled.size() == target &&
+        m_lastTransformMode == transformMode) {
+        return m_lastScaled;
+    }
+    const QPixmap& source = level(target);
+    m_lastScaled = source.size() == target
+                     ? source
+                     : source.scaled(target, Qt::IgnoreAspectRatio, transformMode);
+    m_lastTransformMode = transformMode;
+    return m_lastScaled;
+}
+
+qint64 PinZoomCache::memoryUsage() const
+{
+    qint64 bytes = 0;
+    for (int i = 1; i < m_levels.size(); ++i) {
+        const QPixmap& p = m_levels.at(i);
+        bytes += static_cast<qint64>(p.width()) * p.height() * p.depth() / 8;
+    }
+    return bytes;
+}
+
+const QPixmap& PinZoomCache::level(const QSize& size)
+{
+    int index = 0;
+    while (true) {
+        QSize half = m_levels.at(index).size() / 2;
+        if (half.width() < size.width() || half.height() < size.height() ||
+            half.isEmpty()) {
+            return m_levels.at(index);
+        }
+        if (index + 1 == m_levels.size()) {
+            // Halving averages blocks of 2x2 pixels, which is cheap and
+            // doesn't lose any detail for the next level
+            m_levels << m_levels.last().scaled(
+              half, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        }
+        ++index;
+    }
+}
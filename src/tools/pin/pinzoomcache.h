@@ -0,0 +1,33 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QPixmap>
+#include <QVector>
+
+// Mipmap pyramid of a pinned screenshot. Every level is half the size of the
+// previous one, the first level being the pixmap itself. A zoomed copy is
+// scaled from the smallest level that is still larger than the requested
+// size, so zooming out of a large pin never rescales the full resolution
+// pixmap. The levels are created the first time they are needed.
+class PinZoomCache
+{
+public:
+    void setSource(const QPixmap& pixmap);
+    void clear();
+
+    QPixmap scaled(const QSize& size,
+                   Qt::AspectRatioMode aspectRatioMode,
+                   Qt::TransformationMode transformMode);
+
+    // Bytes used by the downscaled levels
+    qint64 memoryUsage() const;
+
+private:
+    const QPixmap& level(const QSize& size);
+
+    QVector<QPixmap> m_levels;
+    QPixmap m_lastScaled;
+    Qt::TransformationMode m_lastTransformMode = Qt::FastTransformation;
+};
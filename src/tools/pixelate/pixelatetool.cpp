@@ -16,7 +16,7 @@ PixelateTool::PixelateTool(QObject* parent)
 QIcon PixelateTool::icon(const QColor& background, bool inEditor) const
 {
     Q_UNUSED(inEditor)
-    return QIcon(iconPath(background) + "pixelate.svg");
+    return IconAtlas::icon(iconPath(background) + "pixelate.svg");
 }
 
 QString PixelateTool::name() const
@@ -48,10 +48,15 @@ CaptureTool* PixelateTool::copy(QObject* parent)
 
 void PixelateTool::process(QPainter& painter, const QPixmap& pixmap)
 {
-    QRect selection = boundingRect().intersected(pixmap.rect());
+    // The painter is translated when only a part of the capture is rendered,
+    // so the pixmap is read through the same transformation
+    const QTransform& transform = painter.transform();
+    QRect selection = boundingRect().intersected(
+      transform.inverted().mapRect(pixmap.rect()));
+    QRect source = transform.mapRect(selection);
     auto pixelRatio = pixmap.devicePixelRatio();
-    QRect selectionScaled = QRect(selection.topLeft() * pixelRatio,
-                                  selection.bottomRight() * pixelRatio);
+    QRect selectionScaled = QRect(source.topLeft() * pixelRatio,
+                                  source.bottomRight() * pixelRatio);
 
     // If thickness is less than 1, use old blur process
     if (size() <= 1) {
@@ -15,7 +15,7 @@ RectangleTool::RectangleTool(QObject* parent)
 QIcon RectangleTool::icon(const QColor& background, bool inEditor) const
 {
     Q_UNUSED(inEditor)
-    return QIcon(iconPath(background) + "square.svg");
+    return IconAtlas::icon(iconPath(background) + "square.svg");
 }
 QString RectangleTool::name() const
 {
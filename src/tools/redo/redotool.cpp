@@ -16,7 +16,7 @@ bool RedoTool::closeOnButtonPressed() const
 QIcon RedoTool::icon(const QColor& background, bool inEditor) const
 {
     Q_UNUSED(inEditor)
-    return QIcon(iconPath(background) + "redo-variant.svg");
+    return IconAtlas::icon(iconPath(background) + "redo-variant.svg");
 }
 QString RedoTool::name() const
 {
@@ -18,7 +18,7 @@ bool SelectionTool::closeOnButtonPressed() const
 QIcon SelectionTool::icon(const QColor& background, bool inEditor) const
 {
     Q_UNUSED(inEditor)
-    return QIcon(iconPath(background) + "square-outline.svg");
+    return IconAtlas::icon(iconPath(background) + "square-outline.svg");
 }
 QString SelectionTool::name() const
 {
@@ -30,7 +30,7 @@ bool SizeDecreaseTool::closeOnButtonPressed() const
 QIcon SizeDecreaseTool::icon(const QColor& background, bool inEditor) const
 {
     Q_UNUSED(inEditor)
-    return QIcon(iconPath(background) + "minus.svg");
+    return IconAtlas::icon(iconPath(background) + "minus.svg");
 }
 QString SizeDecreaseTool::name() const
 {
@@ -30,7 +30,7 @@ bool SizeIncreaseTool::closeOnButtonPressed() const
 QIcon SizeIncreaseTool::icon(const QColor& background, bool inEditor) const
 {
     Q_UNUSED(inEditor)
-    return QIcon(iconPath(background) + "plus.svg");
+    return IconAtlas::icon(iconPath(background) + "plus.svg");
 }
 QString SizeIncreaseTool::name() const
 {
@@ -4,16 +4,95 @@
 #include "textconfig.h"
 #include "src/utils/colorutils.h"
 #include "src/utils/confighandler.h"
+#include "src/utils/fontfamilyindex.h"
+#include "src/utils/iconatlas.h"
 #include "src/utils/pathinfo.h"
+#include <QAbstractListModel>
 #include <QComboBox>
-#include <QFontDatabase>
+#include <QCompleter>
 #include <QHBoxLayout>
+#include <QListView>
 #include <QPushButton>
+#include <QStringListModel>
+
+// Rows handed to the view at once, the popup asks for more as it scrolls
+#define FAMILY_BATCH_SIZE 200
+
+// Families of the FontFamilyIndex. Only the rows the combo box popup has
+// scrolled to exist, thousands of families are not laid out upfront.
+class FontFamilyModel : public QAbstractListModel
+{
+public:
+    explicit FontFamilyModel(QObject* parent = nullptr)
+      : QAbstractListModel(parent)
+      , m_fetched(0)
+    {}
+
+    int rowCount(const QModelIndex& parent) const override
+    {
+        return parent.isValid() ? 0 : m_fetched;
+    }
+
+    QVariant data(const QModelIndex& index, int role) const override
+    {
+        if (!index.isValid() || index.row() >= m_fetched ||
+            (role != Qt::DisplayRole && role != Qt::EditRole)) {
+            return QVariant();
+        }
+        return m_families.at(index.row());
+    }
+
+    bool canFetchMore(const QModelIndex& parent) const override
+    {
+        return !parent.isValid() && m_fetched < m_families.size();
+    }
+
+    void fetchMore(const QModelIndex& parent) override
+    {
+        Q_UNUSED(parent)
+        fetchUntil(m_fetched + FAMILY_BATCH_SIZE - 1);
+    }
+
+    void setFamilies(const QStringList& families)
+    {
+        beginResetModel();
+        m_families = families;
+        m_fetched = qMin(FAMILY_BATCH_SIZE, m_families.size());
+        endResetModel();
+    }
+
+    // Row of `family`, the rows up to it are fetched. -1 if it is unknown.
+    int rowOf(const QString& family)
+    {
+        int row = m_families.indexOf(family);
+        if (row >= 0) {
+            fetchUntil(row);
+        }
+        return row;
+    }
+
+private:
+    void fetchUntil(int row)
+    {
+        row = qMin(row, m_families.size() - 1);
+        if (row < m_fetched) {
+            return;
+        }
+        beginInsertRows(QModelIndex(), m_fetched, row);
+        m_fetched = row + 1;
+        endInsertRows();
+    }
+
+    QStringList m_families;
+    int m_fetched;
+};
 
 TextConfig::TextConfig(QWidget* parent)
   : QWidget(parent)
   , m_layout(new QVBoxLayout(this))
   , m_fontsCB(new QComboBox())
+  , m_fontsModel(new FontFamilyModel(this))
+  , m_completionModel(new QStringListModel(this))
   , m_strikeOutButton(nullptr)
   , m_underlineButton(nullptr)
   , m_weightButton(nullptr)
@@ -22,22 +101,45 @@ TextConfig::TextConfig(QWidget* parent)
   , m_centerAlignButton(nullptr)
   , m_rightAlignButton(nullptr)
 {
-
-    QFontDatabase fontDB;
-
+    // The families are enumerated by the daemon, see FontFamilyIndex
+    m_fontsCB->setModel(m_fontsModel);
+    if (auto* view = qobject_cast<QListView*>(m_fontsCB->view())) {
+        view->setUniformItemSizes(true);
+    }
+    // Typing searches the families, the completer has all of them while the
+    // combo box only has the rows fetched so far
+    m_fontsCB->setEditable(true);
+    m_fontsCB->setInsertPolicy(QComboBox::NoInsert);
+    auto* completer = new QCompleter(m_completionModel, this);
+    completer->setCaseSensitivity(Qt::CaseInsensitive);
+    completer->setFilterMode(Qt::MatchContains);
+    m_fontsCB->setCompleter(completer);
+    connect(completer,
+            QOverload<const QString&>::of(&QCompleter::activated),
+            this,
+            &TextConfig::setFontFamily);
     connect(m_fontsCB,
-            &QComboBox::currentTextChanged,
+            QOverload<int>::of(&QComboBox::currentIndexChanged),
             this,
-            &TextConfig::fontFamilyChanged);
-    m_fontsCB->addItems(fontDB.families());
-    setFontFamily(ConfigHandler().fontFamily());
+            [this](int index) {
+                if (index >= 0) {
+                    emit fontFamilyChanged(m_fontsCB->itemText(index));
+                }
+            });
+
+    FontFamilyIndex* index = FontFamilyIndex::instance();
+    connect(
+      index, &FontFamilyIndex::updated, this, &TextConfig::updateFamilies);
+    index->load();
+    updateFamilies();
 
     QString iconPrefix = ColorUtils::colorIsDark(palette().windowText().color())
                            ? PathInfo::blackIconPath()
                            : PathInfo::whiteIconPath();
 
-    m_strikeOutButton = new QPushButton(
-      QIcon(iconPrefix + "format_strikethrough.svg"), QLatin1String(""));
+    m_strikeOutButton =
+      new QPushButton(IconAtlas::icon(iconPrefix + "format_strikethrough.svg"),
+                      QLatin1String(""));
     m_strikeOutButton->setCheckable(true);
     connect(m_strikeOutButton,
             &QPushButton::clicked,
@@ -45,8 +147,9 @@ TextConfig::TextConfig(QWidget* parent)
             &TextConfig::fontStrikeOutChanged);
     m_strikeOutButton->setToolTip(tr("StrikeOut"));
 
-    m_underlineButton = new QPushButton(
-      QIcon(iconPrefix + "format_underlined.svg"), QLatin1String(""));
+    m_underlineButton =
+      new QPushButton(IconAtlas::icon(iconPrefix + "format_underlined.svg"),
+                      QLatin1String(""));
     m_underlineButton->setCheckable(true);
     connect(m_underlineButton,
             &QPushButton::clicked,
@@ -54,8 +157,8 @@ TextConfig::TextConfig(QWidget* parent)
             &TextConfig::fontUnderlineChanged);
     m_underlineButton->setToolTip(tr("Underline"));
 
-    m_weightButton =
-      new QPushButton(QIcon(iconPrefix + "format_bold.svg"), QLatin1String(""));
+    m_weightButton = new QPushButton(
+      IconAtlas::icon(iconPrefix + "format_bold.svg"), QLatin1String(""));
     m_weightButton->setCheckable(true);
     connect(m_weightButton,
             &QPushButton::clicked,
@@ -63,8 +166,8 @@ TextConfig::TextConfig(QWidget* parent)
             &TextConfig::weightButtonPressed);
     m_weightButton->setToolTip(tr("Bold"));
 
-    m_italicButton = new QPushButton(QIcon(iconPrefix + "format_italic.svg"),
-                                     QLatin1String(""));
+    m_italicButton = new QPushButton(
+      IconAtlas::icon(iconPrefix + "format_italic.svg"), QLatin1String(""));
     m_italicButton->setCheckable(true);
     connect(m_italicButton,
             &QPushButton::clicked,
@@ -73,8 +176,8 @@ TextConfig::TextConfig(QWidget* parent)
     m_italicButton->setToolTip(tr("Italic"));
     auto* modifiersLayout = new QHBoxLayout();
 
-    m_leftAlignButton =
-      new QPushButton(QIcon(iconPrefix + "leftalign.svg"), QLatin1String(""));
+    m_leftAlignButton = new QPushButton(
+      IconAtlas::icon(iconPrefix + "leftalign.svg"), QLatin1String(""));
     m_leftAlignButton->setCheckable(true);
     m_leftAlignButton->setAutoExclusive(true);
     connect(m_leftAlignButton, &QPushButton::clicked, this, [this] {
@@ -82,8 +185,8 @@ TextConfig::TextConfig(QWidget* parent)
     });
     m_leftAlignButton->setToolTip(tr("Left Align"));
 
-    m_centerAlignButton =
-      new QPushButton(QIcon(iconPrefix + "centeralign.svg"), QLatin1String(""));
+    m_centerAlignButton = new QPushButton(
+      IconAtlas::icon(iconPrefix + "centeralign.svg"), QLatin1String(""));
     m_centerAlignButton->setCheckable(true);
     m_centerAlignButton->setAutoExclusive(true);
     connect(m_centerAlignButton, &QPushButton::clicked, this, [this] {
@@ -91,8 +194,8 @@ TextConfig::TextConfig(QWidget* parent)
     });
     m_centerAlignButton->setToolTip(tr("Center Align"));
 
-    m_rightAlignButton =
-      new QPushButton(QIcon(iconPrefix + "rightalign.svg"), QLatin1String(""));
+    m_rightAlignButton = new QPushButton(
+      IconAtlas::icon(iconPrefix + "rightalign.svg"), QLatin1String(""));
     m_rightAlignButton->setCheckable(true);
     m_rightAlignButton->setAutoExclusive(true);
     connect(m_rightAlignButton, &QPushButton::clicked, this, [this] {
@@ -117,7 +220,25 @@ TextConfig::TextConfig(QWidget* parent)
 void TextConfig::setFontFamily(const QString& fontFamily)
 {
     m_fontsCB->setCurrentIndex(
-      m_fontsCB->findText(fontFamily.isEmpty() ? font().family() : fontFamily));
+      m_fontsModel->rowOf(fontFamily.isEmpty() ? font().family() : fontFamily));
+}
+
+void TextConfig::updateFamilies()
+{
+    QString current = m_fontsCB->currentIndex() >= 0
+                        ? m_fontsCB->currentText()
+                        : ConfigHandler().fontFamily();
+    QStringList families = FontFamilyIndex::instance()->families();
+    if (families.isEmpty()) {
+        // First enumeration still running, show the family in use meanwhile
+        families << (current.isEmpty() ? font().family() : current);
+    }
+    // Resetting the model is not a change of the family
+    m_fontsCB->blockSignals(true);
+    m_fontsModel->setFamilies(families);
+    m_completionModel->setStringList(families);
+    setFontFamily(current);
+    m_fontsCB->blockSignals(false);
 }
 
 void TextConfig::setUnderline(const bool underline)
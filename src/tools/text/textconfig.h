@@ -8,6 +8,8 @@
 class QVBoxLayout;
 class QPushButton;
 class QComboBox;
+class QStringListModel;
+class FontFamilyModel;
 
 class TextConfig : public QWidget
 {
@@ -33,10 +35,13 @@ public slots:
 
 private slots:
     void weightButtonPressed(bool weight);
+    void updateFamilies();
 
 private:
     QVBoxLayout* m_layout;
     QComboBox* m_fontsCB;
+    FontFamilyModel* m_fontsModel;
+    QStringListModel* m_completionModel;
     QPushButton* m_strikeOutButton;
     QPushButton* m_underlineButton;
     QPushButton* m_weightButton;
@@ -8,10 +8,12 @@
 
 #define BASE_POINT_SIZE 8
 #define MAX_INFO_LENGTH 24
+#define TEXT_AREA_PADDING 5
 
 TextTool::TextTool(QObject* parent)
   : CaptureTool(parent)
   , m_size(1)
+  , m_layoutAlignment(Qt::AlignLeft)
 {
     QString fontFamily = ConfigHandler().fontFamily();
     if (!fontFamily.isEmpty()) {
@@ -35,6 +37,10 @@ void TextTool::copyParams(const TextTool* from, TextTool* to)
     to->m_color = from->m_color;
     to->m_textArea = from->m_textArea;
     to->m_currentPos = from->m_currentPos;
+    to->m_layout = from->m_layout;
+    to->m_layoutText = from->m_layoutText;
+    to->m_layoutFont = from->m_layoutFont;
+    to->m_layoutAlignment = from->m_layoutAlignment;
 }
 
 bool TextTool::isValid() const
@@ -65,7 +71,7 @@ QRect TextTool::boundingRect() const
 QIcon TextTool::icon(const QColor& background, bool inEditor) const
 {
     Q_UNUSED(inEditor)
-    return QIcon(iconPath(background) + "text.svg");
+    return IconAtlas::icon(iconPath(background) + "text.svg");
 }
 
 QString TextTool::name() const
@@ -199,20 +205,16 @@ void TextTool::process(QPainter& painter, const QPixmap& pixmap)
     if (m_text.isEmpty()) {
         return;
     }
-    const int val = 5;
+    const int val = TEXT_AREA_PADDING;
     QFont orig_font = painter.font();
     QPen orig_pen = painter.pen();
-    QFontMetrics fm(m_font);
-    QSize fontsize(fm.boundingRect(QRect(), 0, m_text).size());
-    fontsize.setWidth(fontsize.width() + val * 2);
-    fontsize.setHeight(fontsize.height() + val * 2);
-    m_textArea.setSize(fontsize);
+    updateTextArea();
     // draw text
     painter.setFont(m_font);
     painter.setPen(m_color);
     if (!editMode()) {
-        painter.drawText(
-          m_textArea + QMargins(-val, -val, val, val), m_alignment, m_text);
+        painter.drawStaticText(m_textArea.topLeft() + QPoint(val, val),
+                               m_layout);
     }
     painter.setFont(orig_font);
     painter.setPen(orig_pen);
@@ -271,6 +273,7 @@ void TextTool::onSizeChanged(int size)
 {
     m_size = size;
     m_font.setPointSize(m_size + BASE_POINT_SIZE);
+    updateTextArea();
     if (m_widget != nullptr) {
         m_widget->setFont(m_font);
     }
@@ -279,11 +282,13 @@ void TextTool::onSizeChanged(int size)
 void TextTool::updateText(const QString& newText)
 {
     m_text = newText;
+    updateTextArea();
 }
 
 void TextTool::updateFamily(const QString& text)
 {
     m_font.setFamily(text);
+    updateTextArea();
     if (m_textOld.isEmpty()) {
         ConfigHandler().setFontFamily(m_font.family());
     }
@@ -295,6 +300,7 @@ void TextTool::updateFamily(const QString& text)
 void TextTool::updateFontUnderline(const bool underlined)
 {
     m_font.setUnderline(underlined);
+    updateTextArea();
     if (m_widget != nullptr) {
         m_widget->setFont(m_font);
     }
@@ -303,6 +309,7 @@ void TextTool::updateFontUnderline(const bool underlined)
 void TextTool::updateFontStrikeOut(const bool strikeout)
 {
     m_font.setStrikeOut(strikeout);
+    updateTextArea();
     if (m_widget != nullptr) {
         m_widget->setFont(m_font);
     }
@@ -311,6 +318,7 @@ void TextTool::updateFontStrikeOut(const bool strikeout)
 void TextTool::updateFontWeight(const QFont::Weight weight)
 {
     m_font.setWeight(weight);
+    updateTextArea();
     if (m_widget != nullptr) {
         m_widget->setFont(m_font);
     }
@@ -319,6 +327,7 @@ void TextTool::updateFontWeight(const QFont::Weight weight)
 void TextTool::updateFontItalic(const bool italic)
 {
     m_font.setItalic(italic);
+    updateTextArea();
     if (m_widget != nullptr) {
         m_widget->setFont(m_font);
     }
@@ -351,6 +360,40 @@ void TextTool::setEditMode(bool editMode)
     CaptureTool::setEditMode(editMode);
 }
 
+// Keep the bounding rect and the layout in sync with the text, so the area
+// painted by process() is known before painting
+void TextTool::updateTextArea()
+{
+    if (m_text.isEmpty()) {
+        return;
+    }
+    if (m_text == m_layoutText && m_font == m_layoutFont &&
+        m_alignment == m_layoutAlignment) {
+        return;
+    }
+    const int val = TEXT_AREA_PADDING;
+    QFontMetrics fm(m_font);
+    QSize fontsize(fm.boundingRect(QRect(), 0, m_text).size());
+
+    // QPainter::drawText breaks the lines at '\n', QStaticText only at line
+    // separators
+    QString text = m_text;
+    text.replace(QLatin1Char('\n'), QChar::LineSeparator);
+    m_layout.setText(text);
+    m_layout.setTextFormat(Qt::PlainText);
+    m_layout.setTextOption(QTextOption(m_alignment));
+    // The lines are aligned within the width of the longest one
+    m_layout.setTextWidth(fontsize.width());
+    m_layout.prepare(QTransform(), m_font);
+    m_layoutText = m_text;
+    m_layoutFont = m_font;
+    m_layoutAlignment = m_alignment;
+
+    fontsize.setWidth(fontsize.width() + val * 2);
+    fontsize.setHeight(fontsize.height() + val * 2);
+    m_textArea.setSize(fontsize);
+}
+
 bool TextTool::isChanged()
 {
     return QString::compare(m_text, m_textOld, Qt::CaseInsensitive) != 0;
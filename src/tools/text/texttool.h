@@ -7,6 +7,7 @@
 #include "textconfig.h"
 #include <QPoint>
 #include <QPointer>
+#include <QStaticText>
 class TextWidget;
 class TextConfig;
 
@@ -67,6 +68,7 @@ private slots:
 
 private:
     void closeEditor();
+    void updateTextArea();
 
     QFont m_font;
     Qt::AlignmentFlag m_alignment;
@@ -80,4 +82,12 @@ private:
     QPoint m_currentPos;
 
     QString m_tempString;
+
+    // Layout of m_text drawn by process(), made again by updateTextArea only
+    // when the text, the font or the alignment changed. Copies of the tool
+    // for the undo stack share it.
+    QStaticText m_layout;
+    QString m_layoutText;
+    QFont m_layoutFont;
+    Qt::AlignmentFlag m_layoutAlignment;
 };
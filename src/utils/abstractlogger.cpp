@@ -1,8 +1,12 @@
 #include "abstractlogger.h"
+#include "logfilewriter.h"
 #include "systemnotification.h"
 #include <cassert>
 
+#include <QDateTime>
 #include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
 
 #ifdef Q_OS_WIN
 #include <windows.h>
@@ -12,11 +16,7 @@
 AbstractLogger::AbstractLogger(Channel channel, int targets)
   : m_defaultChannel(channel)
   , m_targets(targets)
-{
-    if (targets & LogFile) {
-        // TODO
-    }
-}
+{}
 
 /**
  * @brief Construct an AbstractLogger with output to a string.
@@ -62,7 +62,7 @@ AbstractLogger& AbstractLogger::sendMessage(const QString& msg, Channel channel)
         }
     }
     if (m_targets & LogFile) {
-        // TODO
+        LogFileWriter::instance()->append(logFileRecord(msg, channel));
     }
 #ifndef Q_OS_WIN
     if (m_targets & Stderr) {
@@ -125,6 +125,51 @@ AbstractLogger& AbstractLogger::enableMessageHeader(bool enable)
     return *this;
 }
 
+/**
+ * @brief Attach the id of the capture request the messages are about, it is
+ * only written to the log file.
+ */
+AbstractLogger& AbstractLogger::attachCaptureId(uint id)
+{
+    m_captureId = id;
+    return *this;
+}
+
+/**
+ * @brief Attach a duration in milliseconds, e.g. the time taken to grab the
+ * screen. Durations are only written to the log file.
+ */
+AbstractLogger& AbstractLogger::addDuration(const QString& name, qint64 msecs)
+{
+    m_durations << qMakePair(name, msecs);
+    return *this;
+}
+
+/**
+ * @brief Format a message as a single line JSON record for the log file.
+ */
+QByteArray AbstractLogger::logFileRecord(const QString& msg, Channel channel)
+{
+    QJsonObject record;
+    record["time"] =
+      QDateTime::currentDateTime().toString(Qt::ISODateWithMs);
+    record["channel"] = channel == Info      ? "info"
+                        : channel == Warning ? "warning"
+                                             : "error";
+    if (m_captureId != 0) {
+        record["capture"] = static_cast<qint64>(m_captureId);
+    }
+    if (!m_durations.isEmpty()) {
+        QJsonObject durations;
+        for (const auto& duration : m_durations) {
+            durations[duration.first] = duration.second;
+        }
+        record["durations"] = durations;
+    }
+    record["message"] = msg;
+    return QJsonDocument(record).toJson(QJsonDocument::Compact);
+}
+
 /**
  * @brief Generate a message header for the given channel and target.
  */
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <QPair>
 #include <QString>
 #include <QTextStream>
+#include <QVector>
 
 /**
  * @brief A class that allows you to log events to where they need to go.
@@ -42,15 +44,20 @@ public:
     AbstractLogger& addOutputString(QString& str);
     AbstractLogger& attachNotificationPath(const QString& path);
     AbstractLogger& enableMessageHeader(bool enable);
+    AbstractLogger& attachCaptureId(uint id);
+    AbstractLogger& addDuration(const QString& name, qint64 msecs);
 
 private:
     QString messageHeader(Channel channel, Target target);
+    QByteArray logFileRecord(const QString& msg, Channel channel);
 
     int m_targets;
     Channel m_defaultChannel;
     QList<QTextStream*> m_textStreams;
     QString m_notificationPath;
     bool m_enableMessageHeader = true;
+    uint m_captureId = 0;
+    QVector<QPair<QString, qint64>> m_durations;
 #ifdef Q_OS_WIN
     bool checkWinInit();
     bool m_bWinInit = false;
@@ -0,0 +1,268 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "colorquantizer.h"
+#include <algorithm>
+#include <climits>
+
+#define REDUCED_COLORS (1 << 15)
+
+namespace {
+inline int reduced(QRgb color)
+{
+    return (qRed(color) >> 3) << 10 | (qGreen(color) >> 3) << 5 |
+           qBlue(color) >> 3;
+}
+
+inline int channel(int color, int index)
+{
+    return (color >> (10 - 5 * index)) & 0x1f;
+}
+
+// Colors of the histogram, in a range of `entries`
+struct Box
+{
+    int begin;
+    int end;
+    qint64 pixels;
+    int longestChannel;
+    int extent;
+};
+
+struct Entry
+{
+    int color;
+    quint32 count;
+};
+
+void measure(Box& box, const QVector<Entry>& entries)
+{
+    int low[3] = { 31, 31, 31 }, high[3] = { 0, 0, 0 };
+    box.pixels = 0;
+    for (int i = box.begin; i < box.end; ++i) {
+        for (int c = 0; c < 3; ++c) {
+            low[c] = qMin(low[c], channel(entries[i].color, c));
+            high[c] = qMax(high[c], channel(entries[i].color, c));
+        }
+        box.pixels += entries[i].count;
+    }
+    box.longestChannel = 0;
+    box.extent = -1;
+    for (int c = 0; c < 3; ++c) {
+        if (high[c] - low[c] > box.extent) {
+            box.extent = high[c] - low[c];
+            box.longestChannel = c;
+        }
+    }
+}
+}
+
+ColorQuantizer::ColorQuantizer()
+  : m_nearest(REDUCED_COLORS, -1)
+{}
+
+ColorQuantizer::ColorQuantizer(const QVector<QRgb>& palette)
+  : m_palette(palette)
+  , m_nearest(REDUCED_COLORS, -1)
+{}
+
+QVector<QRgb> ColorQuantizer::medianCut(const QImage& image,
+                                        int maxColors,
+                                        const QRect& area)
+{
+    const QImage source = image.format() == QImage::Format_RGB32 ||
+                              image.format() == QImage::Format_ARGB32
+                            ? image
+                            : image.convertToFormat(QImage::Format_ARGB32);
+    const QRect rect = area.isNull() ? source.rect() : area & source.rect();
+
+    // Sums of the exact colors, the palette is made of their averages
+    QVector<quint32> counts(REDUCED_COLORS, 0);
+    QVector<quint64> sums(3 * REDUCED_COLORS, 0);
+    for (int y = rect.top(); y <= rect.bottom(); ++y) {
+        const auto* line = reinterpret_cast<const QRgb*>(source.scanLine(y));
+        for (int x = rect.left(); x <= rect.right(); ++x) {
+            const int color = reduced(line[x]);
+            ++counts[color];
+            sums[3 * color] += qRed(line[x]);
+            sums[3 * color + 1] += qGreen(line[x]);
+            sums[3 * color + 2] += qBlue(line[x]);
+        }
+    }
+    QVector<Entry> entries;
+    for (int color = 0; color < REDUCED_COLORS; ++color) {
+        if (counts[color] > 0) {
+            entries.append({ color, counts[color] });
+        }
+    }
+    if (entries.isEmpty() || maxColors <= 0) {
+        return {};
+    }
+
+    QVector<Box> boxes;
+    boxes.append({ 0, static_cast<int>(entries.size()), 0, 0, 0 });
+    measure(boxes.first(), entries);
+    while (boxes.size() < maxColors) {
+        // The box with the most pixels spread over the widest range of a
+        // channel is split
+        int split = -1;
+        qint64 bestScore = 0;
+        for (int i = 0; i < boxes.size(); ++i) {
+            qint64 score = boxes[i].pixels * boxes[i].extent;
+            if (boxes[i].end - boxes[i].begin > 1 && score > bestScore) {
+                bestScore = score;
+                split = i;
+            }
+        }
+        if (split < 0) {
+            break;
+        }
+        Box box = boxes[split];
+        const int c = box.longestChannel;
+        std::sort(entries.begin() + box.begin,
+                  entries.begin() + box.end,
+                  [c](const Entry& a, const Entry& b) {
+                      return channel(a.color, c) < channel(b.color, c);
+                  });
+        // Split at the median pixel, each half keeps at least one color
+        int middle = box.begin + 1;
+        qint64 below = entries[box.begin].count;
+        while (middle < box.end - 1 && below * 2 < box.pixels) {
+            below += entries[middle++].count;
+        }
+        Box upper = { middle, box.end, 0, 0, 0 };
+        box.end = middle;
+        measure(box, entries);
+        measure(upper, entries);
+        boxes[split] = box;
+        boxes.append(upper);
+    }
+
+    QVector<QRgb> palette;
+    palette.reserve(boxes.size());
+    for (const Box& box : qAsConst(boxes)) {
+        quint64 r = 0, g = 0, b = 0;
+        for (int i = box.begin; i < box.end; ++i) {
+            const int color = entries[i].color;
+            r += sums[3 * color];
+            g += sums[3 * color + 1];
+            b += sums[3 * color + 2];
+        }
+        const auto pixels = static_cast<quint64>(box.pixels);
+        palette.append(qRgb(static_cast<int>(r / pixels),
+                            static_cast<int>(g / pixels),
+                            static_cast<int>(b / pixels)));
+    }
+    return palette;
+}
+
+int ColorQuantizer::reducedColorCount(const QImage& image, int limit)
+{
+    const QImage source = image.format() == QImage::Format_RGB32 ||
+                              image.format() == QImage::Format_ARGB32
+                            ? image
+                            : image.convertToFormat(QImage::Format_ARGB32);
+    QVector<bool> seen(REDUCED_COLORS, false);
+    int count = 0;
+    for (int y = 0; y < source.height(); ++y) {
+        const auto* line = reinterpret_cast<const QRgb*>(source.scanLine(y));
+        for (int x = 0; x < source.width(); ++x) {
+            const int color = reduced(line[x]);
+            if (!seen[color]) {
+                seen[color] = true;
+                if (++count >= limit) {
+                    return count;
+                }
+            }
+        }
+    }
+    return count;
+}
+
+const QVector<QRgb>& ColorQuantizer::palette() const
+{
+    return m_palette;
+}
+
+int ColorQuantizer::nearest(QRgb color)
+{
+    const int key = reduced(color);
+    if (m_nearest[key] >= 0) {
+        return m_nearest[key];
+    }
+    // Looked up from the center of the reduced color
+    const QRgb center = qRgb((qRed(color) & 0xf8) | 0x04,
+                             (qGreen(color) & 0xf8) | 0x04,
+                             (qBlue(color) & 0xf8) | 0x04);
+    int best = 0, bestDistance = INT_MAX;
+    for (int i = 0; i < m_palette.size(); ++i) {
+        const int d = distance(center, m_palette[i]);
+        if (d < bestDistance) {
+            bestDistance = d;
+            best = i;
+        }
+    }
+    m_nearest[key] = static_cast<qint16>(best);
+    return best;
+}
+
+int ColorQuantizer::distance(QRgb a, QRgb b)
+{
+    const int r = qRed(a) - qRed(b);
+    const int g = qGreen(a) - qGreen(b);
+    const int bl = qBlue(a) - qBlue(b);
+    return r * r + g * g + bl * bl;
+}
+
+QImage ColorQuantizer::toIndexed(const QImage& image, bool dither)
+{
+    if (m_palette.isEmpty()) {
+        return QImage();
+    }
+    const QImage source = image.convertToFormat(QImage::Format_RGB32);
+    QImage indexed(source.size(), QImage::Format_Indexed8);
+    indexed.setColorTable(m_palette);
+    indexed.setDotsPerMeterX(source.dotsPerMeterX());
+    indexed.setDotsPerMeterY(source.dotsPerMeterY());
+
+    // Error spread to the current and to the next line, in sixteenths and
+    // with a pixel of padding on both sides
+    const int stride = 3 * (source.width() + 2);
+    QVector<int> errors(dither ? 2 * stride : 0, 0);
+    for (int y = 0; y < source.height(); ++y) {
+        const auto* line = reinterpret_cast<const QRgb*>(source.scanLine(y));
+        uchar* out = indexed.scanLine(y);
+        int* current = nullptr;
+        int* next = nullptr;
+        if (dither) {
+            current = errors.data() + (y % 2) * stride;
+            next = errors.data() + ((y + 1) % 2) * stride;
+            std::fill(next, next + stride, 0);
+        }
+        for (int x = 0; x < source.width(); ++x) {
+            QRgb color = line[x];
+            if (dither) {
+                const int* error = current + 3 * (x + 1);
+                color = qRgb(qBound(0, qRed(color) + error[0] / 16, 255),
+                             qBound(0, qGreen(color) + error[1] / 16, 255),
+                             qBound(0, qBlue(color) + error[2] / 16, 255));
+            }
+            const int index = nearest(color);
+            out[x] = static_cast<uchar>(index);
+            if (!dither) {
+                continue;
+            }
+            const QRgb chosen = m_palette[index];
+            const int diff[3] = { qRed(color) - qRed(chosen),
+                                  qGreen(color) - qGreen(chosen),
+                                  qBlue(color) - qBlue(chosen) };
+            for (int c = 0; c < 3; ++c) {
+                current[3 * (x + 2) + c] += diff[c] * 7;
+                next[3 * x + c] += diff[c] * 3;
+                next[3 * (x + 1) + c] += diff[c] * 5;
+                next[3 * (x + 2) + c] += diff[c];
+            }
+        }
+    }
+    return indexed;
+}
@@ -0,0 +1,42 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QImage>
+#include <QVector>
+
+// Maps colors to a palette of at most 256 colors.
+//
+// The palette is made by median cut over a histogram of the colors reduced
+// to 5 bits per channel. The nearest palette color is looked up once per
+// reduced color and remembered, so mapping a whole image costs little more
+// than reading it.
+class ColorQuantizer
+{
+public:
+    ColorQuantizer();
+    explicit ColorQuantizer(const QVector<QRgb>& palette);
+
+    // Palette of at most `maxColors` colors for the pixels of `image` in
+    // `area`, the whole image when it is null. The alpha is ignored.
+    static QVector<QRgb> medianCut(const QImage& image,
+                                   int maxColors,
+                                   const QRect& area = QRect());
+
+    // Number of colors of `image` once reduced to 5 bits per channel,
+    // counting stops at `limit`. The alpha is ignored.
+    static int reducedColorCount(const QImage& image, int limit);
+
+    const QVector<QRgb>& palette() const;
+    // Index of the palette color nearest to `color`
+    int nearest(QRgb color);
+    static int distance(QRgb a, QRgb b);
+    // `image` mapped to the palette, optionally with Floyd-Steinberg
+    // dithering. The alpha is dropped.
+    QImage toIndexed(const QImage& image, bool dither);
+
+private:
+    QVector<QRgb> m_palette;
+    QVector<qint16> m_nearest;
+};
@@ -96,6 +96,10 @@ static QMap<class QString, QSharedPointer<ValueHandler>>
     OPTION("useJpgForClipboard"          ,Bool               ( false         )),
     OPTION("uploadWithoutConfirmation"   ,Bool               ( false         )),
     OPTION("saveAfterCopy"               ,Bool               ( false         )),
+    OPTION("optimizePngOnSave"           ,Bool               ( false         )),
+    OPTION("optimizePngOnCopy"           ,Bool               ( false         )),
+    OPTION("optimizePngOnUpload"         ,Bool               ( false         )),
+    OPTION("optimizePngDither"           ,Bool               ( false         )),
     OPTION("savePath"                    ,ExistingDir        (                   )),
     OPTION("savePathFixed"               ,Bool               ( false         )),
     OPTION("saveAsFileExtension"         ,SaveFileExtension  (                   )),
@@ -127,6 +131,7 @@ static QMap<class QString, QSharedPointer<ValueHandler>>
     OPTION("showSelectionGeometry"  , BoundedInt             (0, 5, 4)),
     OPTION("showSelectionGeometryHideTime", LowerBoundedInt  (0, 3000)),
     OPTION("jpegQuality", BoundedInt     (0,100,75)),
+    OPTION("pinMemoryBudget", LowerBoundedInt                (0, 1024)),
     OPTION("delayTakeScreenshotTime", BoundedInt             (0, 30000, 5000)),
 };
 
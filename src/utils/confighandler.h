@@ -115,6 +115,10 @@ public:
     CONFIG_GETTER_SETTER(uploadWithoutConfirmation,
                          setUploadWithoutConfirmation,
                          bool)
+    CONFIG_GETTER_SETTER(optimizePngOnSave, setOptimizePngOnSave, bool)
+    CONFIG_GETTER_SETTER(optimizePngOnCopy, setOptimizePngOnCopy, bool)
+    CONFIG_GETTER_SETTER(optimizePngOnUpload, setOptimizePngOnUpload, bool)
+    CONFIG_GETTER_SETTER(optimizePngDither, setOptimizePngDither, bool)
     CONFIG_GETTER_SETTER(ignoreUpdateToVersion,
                          setIgnoreUpdateToVersion,
                          QString)
@@ -128,6 +132,7 @@ public:
     CONFIG_GETTER_SETTER(saveLastRegion, setSaveLastRegion, bool)
     CONFIG_GETTER_SETTER(showSelectionGeometry, setShowSelectionGeometry, int)
     CONFIG_GETTER_SETTER(jpegQuality, setJpegQuality, int)
+    CONFIG_GETTER_SETTER(pinMemoryBudget, setPinMemoryBudget, int)
     CONFIG_GETTER_SETTER(showSelectionGeometryHideTime,
                          showSelectionGeometryHideTime,
                          int)
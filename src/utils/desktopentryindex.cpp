@@ -0,0 +1,204 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "desktopentryindex.h"
+#include "src/config/cacheutils.h"
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QLocale>
+#include <QSaveFile>
+#include <QSet>
+#include <QStandardPaths>
+#include <QThread>
+
+namespace {
+const quint32 CACHE_MAGIC = 0x464c4445; // "FLDE"
+const qint32 CACHE_VERSION = 1;
+}
+
+// Outside of the anonymous namespace to be found by the QVector operators
+static QDataStream& operator<<(QDataStream& out, const DesktopAppData& app)
+{
+    return out << app.name << app.description << app.exec << app.categories
+               << app.iconName << app.showInTerminal;
+}
+
+static QDataStream& operator>>(QDataStream& in, DesktopAppData& app)
+{
+    return in >> app.name >> app.description >> app.exec >> app.categories >>
+           app.iconName >> app.showInTerminal;
+}
+
+class DesktopEntryScanner : public QThread
+{
+public:
+    void run() override
+    {
+        // Take the stamps first, anything changing during the scan will
+        // trigger another one
+        stamps = DesktopEntryIndex::directoryStamps();
+        apps = DesktopEntryIndex::scanDirectories();
+        DesktopEntryIndex::writeCache(stamps, apps);
+    }
+
+    DesktopEntryIndex::DirectoryStamps stamps;
+    QVector<DesktopAppData> apps;
+};
+
+DesktopEntryIndex::DesktopEntryIndex(QObject* parent)
+  : QObject(parent)
+  , m_refreshing(false)
+{}
+
+void DesktopEntryIndex::load()
+{
+    DirectoryStamps cachedStamps;
+    QVector<DesktopAppData> cachedApps;
+    if (readCache(cachedStamps, cachedApps)) {
+        m_apps = cachedApps;
+        if (cachedStamps == directoryStamps()) {
+            return;
+        }
+    }
+
+    m_refreshing = true;
+    // The scanner isn't owned by the index, it has to outlive it when the
+    // launcher is closed before the scan finishes
+    auto* scanner = new DesktopEntryScanner();
+    connect(scanner, &QThread::finished, this, [this, scanner]() {
+        m_refreshing = false;
+        m_apps = scanner->apps;
+        emit updated();
+    });
+    connect(scanner, &QThread::finished, scanner, &QObject::deleteLater);
+    scanner->start(QThread::LowPriority);
+}
+
+bool DesktopEntryIndex::isRefreshing() const
+{
+    return m_refreshing;
+}
+
+const QVector<DesktopAppData>& DesktopEntryIndex::apps() const
+{
+    return m_apps;
+}
+
+QMap<QString, QVector<DesktopAppData>> DesktopEntryIndex::getAppsByCategory(
+  const QStringList& categories) const
+{
+    QMap<QString, QVector<DesktopAppData>> res;
+    for (const DesktopAppData& app : m_apps) {
+        for (const QString& category : categories) {
+            if (app.categories.contains(category)) {
+                res[category].append(app);
+            }
+        }
+    }
+    return res;
+}
+
+QStringList DesktopEntryIndex::directories()
+{
+    QStringList candidates;
+    candidates << QDir::homePath() + "/.local/share/applications";
+    candidates << QStandardPaths::standardLocations(
+      QStandardPaths::ApplicationsLocation);
+    candidates << QStringLiteral("/usr/share/applications");
+
+    QStringList res;
+    for (const QString& dir : qAsConst(candidates)) {
+        QString path = QDir::cleanPath(dir);
+        if (!res.contains(path)) {
+            res << path;
+        }
+    }
+    return res;
+}
+
+QString DesktopEntryIndex::cacheFile()
+{
+    return getCachePath() + "/desktopentries.cache";
+}
+
+DesktopEntryIndex::DirectoryStamps DesktopEntryIndex::directoryStamps()
+{
+    DirectoryStamps stamps;
+    for (const QString& dir : directories()) {
+        QFileInfo info(dir);
+        // A missing directory has to invalidate the cache once created
+        qint64 modified =
+          info.exists() ? info.lastModified().toMSecsSinceEpoch() : -1;
+        stamps << qMakePair(dir, modified);
+    }
+    return stamps;
+}
+
+QVector<DesktopAppData> DesktopEntryIndex::scanDirectories()
+{
+    DesktopFileParser parser;
+    QVector<DesktopAppData> apps;
+    // An entry hides the entries with the same file name in the directories
+    // of lower priority, even when it's not displayed itself
+    QSet<QString> ids;
+    for (const QString& path : directories()) {
+        QDir dir(path);
+        QStringList entries =
+          dir.entryList({ "*.desktop" }, QDir::NoDotAndDotDot | QDir::Files);
+        for (const QString& file : qAsConst(entries)) {
+            if (ids.contains(file)) {
+                continue;
+            }
+            ids.insert(file);
+            bool ok;
+            DesktopAppData app =
+              parser.parseDesktopFile(dir.absoluteFilePath(file), ok);
+            if (ok) {
+                apps.append(app);
+            }
+        }
+    }
+    return apps;
+}
+
+bool DesktopEntryIndex::readCache(DirectoryStamps& stamps,
+                                  QVector<DesktopAppData>& apps)
+{
+    QFile file(cacheFile());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_9);
+    quint32 magic;
+    qint32 version;
+    QString locale;
+    in >> magic >> version;
+    if (magic != CACHE_MAGIC || version != CACHE_VERSION) {
+        return false;
+    }
+    // The names and descriptions are translated
+    in >> locale;
+    if (locale != QLocale().name()) {
+        return false;
+    }
+    in >> stamps >> apps;
+    return in.status() == QDataStream::Ok;
+}
+
+void DesktopEntryIndex::writeCache(const DirectoryStamps& stamps,
+                                   const QVector<DesktopAppData>& apps)
+{
+    // Readers never see a partially written cache
+    QSaveFile file(cacheFile());
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_9);
+    out << CACHE_MAGIC << CACHE_VERSION << QLocale().name() << stamps << apps;
+    file.commit();
+}
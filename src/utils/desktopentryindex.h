@@ -0,0 +1,53 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include "src/utils/desktopfileparse.h"
+#include <QMap>
+#include <QObject>
+#include <QVector>
+
+// Index of the desktop entries of the applications directories.
+//
+// The parsed entries are stored in a binary file in the cache directory
+// together with the modification time of every directory, so opening the
+// launcher doesn't parse any desktop file unless a directory changed. When
+// the cache is missing or outdated the directories are parsed again in a
+// background thread and updated() is emitted once the new entries are ready.
+class DesktopEntryIndex : public QObject
+{
+    Q_OBJECT
+public:
+    explicit DesktopEntryIndex(QObject* parent = nullptr);
+
+    // Load the cached entries, a refresh is started when they are outdated
+    void load();
+    bool isRefreshing() const;
+
+    const QVector<DesktopAppData>& apps() const;
+    QMap<QString, QVector<DesktopAppData>> getAppsByCategory(
+      const QStringList& categories) const;
+
+    // Directories scanned for desktop entries, by decreasing priority
+    static QStringList directories();
+
+signals:
+    void updated();
+
+private:
+    using DirectoryStamps = QVector<QPair<QString, qint64>>;
+
+    static QString cacheFile();
+    static DirectoryStamps directoryStamps();
+    static QVector<DesktopAppData> scanDirectories();
+    static bool readCache(DirectoryStamps& stamps,
+                          QVector<DesktopAppData>& apps);
+    static void writeCache(const DirectoryStamps& stamps,
+                           const QVector<DesktopAppData>& apps);
+
+    QVector<DesktopAppData> m_apps;
+    bool m_refreshing;
+
+    friend class DesktopEntryScanner;
+};
@@ -37,6 +37,9 @@ struct DesktopAppData
     QString description;
     QString exec;
     QStringList categories;
+    // Name of the icon in the icon theme, the icon itself is only looked up
+    // when it's displayed
+    QString iconName;
     QIcon icon;
     bool showInTerminal;
 };
@@ -57,6 +60,5 @@ private:
     QString m_localeNameShort;
     QString m_localeDescriptionShort;
 
-    QIcon m_defaultIcon;
     QVector<DesktopAppData> m_appList;
 };
@@ -0,0 +1,118 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "filenameformatter.h"
+#include <algorithm>
+#include <vector>
+
+namespace {
+// strftime specifiers allowed in a pattern
+const std::string TIME_SPECIFIERS = "aAbBcCdDeFgGhHIjmMnprRStTuUVwWxXyYzZ";
+}
+
+FilenameFormatter::FilenameFormatter(const QString& pattern)
+  : m_source(pattern)
+{
+    static const std::vector<std::pair<std::string, Token::Type>> names{
+        { "counter", Token::Counter }, { "screen", Token::Screen },
+        { "id", Token::CaptureId },    { "width", Token::Width },
+        { "height", Token::Height },
+    };
+
+    std::string text = pattern.toStdString();
+    // remove trailing characters '%' in the pattern
+    while (!text.empty() && text.back() == '%') {
+        text.pop_back();
+    }
+
+    size_t i = 0;
+    while (i < text.size()) {
+        if (text[i] != '%') {
+            appendTime(std::string(1, text[i]));
+            ++i;
+            continue;
+        }
+        // There is always a character after '%', trailing ones are removed
+        char specifier = text[i + 1];
+        if (specifier == '{') {
+            size_t end = text.find('}', i + 2);
+            if (end != std::string::npos) {
+                std::string name = text.substr(i + 2, end - i - 2);
+                auto it = std::find_if(
+                  names.begin(), names.end(), [&name](const auto& n) {
+                      return n.first == name;
+                  });
+                if (it != names.end()) {
+                    m_tokens << Token{ it->second, {} };
+                    m_usesCounter |= it->second == Token::Counter;
+                    i = end + 1;
+                    continue;
+                }
+            }
+        } else if (TIME_SPECIFIERS.find(specifier) != std::string::npos) {
+            appendTime(std::string{ '%', specifier });
+            i += 2;
+            continue;
+        }
+        // Unknown specifier, keep the '%' as it is
+        appendTime("%%");
+        ++i;
+    }
+}
+
+const QString& FilenameFormatter::source() const
+{
+    return m_source;
+}
+
+bool FilenameFormatter::usesCounter() const
+{
+    return m_usesCounter;
+}
+
+QString FilenameFormatter::format(const FilenameContext& context,
+                                  std::time_t time) const
+{
+    QString result;
+    std::tm localTime = *std::localtime(&time);
+    std::vector<char> buffer;
+    for (const Token& token : m_tokens) {
+        switch (token.type) {
+            case Token::Time: {
+                buffer.resize(token.format.size() * 4 + 128);
+                size_t length = std::strftime(buffer.data(),
+                                              buffer.size(),
+                                              token.format.c_str(),
+                                              &localTime);
+                result += QString::fromUtf8(buffer.data(), length);
+                break;
+            }
+            case Token::Counter:
+                result += QString::number(context.counter);
+                break;
+            case Token::Screen:
+                if (context.screen >= 0) {
+                    result += QString::number(context.screen);
+                }
+                break;
+            case Token::CaptureId:
+                result += QString::number(context.captureId);
+                break;
+            case Token::Width:
+                result += QString::number(context.size.width());
+                break;
+            case Token::Height:
+                result += QString::number(context.size.height());
+                break;
+        }
+    }
+    return result;
+}
+
+void FilenameFormatter::appendTime(const std::string& text)
+{
+    if (m_tokens.isEmpty() || m_tokens.last().type != Token::Time) {
+        m_tokens << Token{ Token::Time, {} };
+    }
+    m_tokens.last().format += text;
+}
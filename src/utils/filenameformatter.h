@@ -0,0 +1,63 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QSize>
+#include <QString>
+#include <QVector>
+#include <ctime>
+#include <string>
+
+// Values of the capture specific tokens of a file name pattern
+struct FilenameContext
+{
+    uint captureId = 0;
+    // Index of the captured screen, -1 if unknown or several screens
+    int screen = -1;
+    QSize size;
+    quint64 counter = 0;
+};
+
+// File name pattern compiled into a list of tokens.
+//
+// Besides the strftime specifiers, a pattern can contain the tokens
+// %{counter}, %{screen}, %{id}, %{width} and %{height}. Time specifiers and
+// the literal text around them are merged into a single strftime format, so
+// formatting a name calls strftime once for every run of them. Unknown
+// specifiers are kept as they are.
+class FilenameFormatter
+{
+public:
+    FilenameFormatter() = default;
+    explicit FilenameFormatter(const QString& pattern);
+
+    const QString& source() const;
+    bool usesCounter() const;
+
+    QString format(const FilenameContext& context, std::time_t time) const;
+
+private:
+    struct Token
+    {
+        enum Type
+        {
+            Time,
+            Counter,
+            Screen,
+            CaptureId,
+            Width,
+            Height
+        };
+
+        Type type;
+        // strftime format of a Time token
+        std::string format;
+    };
+
+    void appendTime(const std::string& text);
+
+    QString m_source;
+    QVector<Token> m_tokens;
+    bool m_usesCounter = false;
+};
@@ -4,8 +4,10 @@
 #include "filenamehandler.h"
 #include "abstractlogger.h"
 #include "src/utils/confighandler.h"
-#include "src/utils/strfparse.h"
 #include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
 #include <ctime>
 #include <exception>
 #include <locale>
@@ -24,30 +26,98 @@ FileNameHandler::FileNameHandler(QObject* parent)
     }
 }
 
-QString FileNameHandler::parsedPattern()
+namespace {
+// Captures are saved from several threads at once, this guards all the
+// state below
+QMutex namesMutex;
+
+// Pattern from the configuration, compiled the first time it is needed
+FilenameFormatter compiledPattern;
+bool compiledPatternValid = false;
+
+// Incremented for every file name reserved from a pattern using %{counter}
+quint64 patternCounter = 0;
+}
+
+/**
+ * @brief Format the configured pattern, without re-reading the configuration
+ * unless it has changed. %{counter} shows the number the next saved capture
+ * gets, without taking it.
+ */
+QString FileNameHandler::parsedPattern(FilenameContext context)
 {
-    return parseFilename(ConfigHandler().filenamePattern());
+    return formatPattern(context, false);
 }
 
+/**
+ * @brief Format `name` as a preview, with example values for the capture
+ * specific tokens.
+ */
 QString FileNameHandler::parseFilename(const QString& name)
 {
-    QString res = name;
-    if (name.isEmpty()) {
-        res = ConfigHandler().filenamePatternDefault();
+    FilenameFormatter pattern(
+      name.isEmpty() ? ConfigHandler().filenamePatternDefault() : name);
+    FilenameContext context;
+    context.captureId = 1;
+    context.screen = 0;
+    context.size = QSize(1920, 1080);
+    {
+        QMutexLocker locker(&namesMutex);
+        context.counter = patternCounter + 1;
     }
+    return sanitize(pattern.format(context, std::time(nullptr)));
+}
 
-    // remove trailing characters '%' in the pattern
-    while (res.endsWith('%')) {
-        res.chop(1);
+/**
+ * @brief Drop the compiled pattern, it is compiled again from the
+ * configuration the next time a name is generated.
+ */
+void FileNameHandler::invalidatePattern()
+{
+    QMutexLocker locker(&namesMutex);
+    compiledPatternValid = false;
+}
+
+QString FileNameHandler::formatPattern(FilenameContext context,
+                                       bool takeCounter)
+{
+    QMutexLocker locker(&namesMutex);
+    const FilenameFormatter& pattern = configuredPattern();
+    if (takeCounter && pattern.usesCounter()) {
+        context.counter = ++patternCounter;
+    } else {
+        context.counter = patternCounter + 1;
     }
+    return sanitize(pattern.format(context, std::time(nullptr)));
+}
 
-    res =
-      QString::fromStdString(strfparse::format_time_string(name.toStdString()));
+// Must be called with namesMutex locked
+const FilenameFormatter& FileNameHandler::configuredPattern()
+{
+    static bool watching = false;
+    if (!watching) {
+        QObject::connect(ConfigHandler::getInstance(),
+                         &ConfigHandler::fileChanged,
+                         &FileNameHandler::invalidatePattern);
+        watching = true;
+    }
+    if (!compiledPatternValid) {
+        ConfigHandler config;
+        QString source = config.filenamePattern();
+        if (source.isEmpty()) {
+            source = config.filenamePatternDefault();
+        }
+        compiledPattern = FilenameFormatter(source);
+        compiledPatternValid = true;
+    }
+    return compiledPattern;
+}
 
-    // add the parsed pattern in a correct format for the filesystem
-    res = res.replace(QLatin1String("/"), QStringLiteral("⁄"))
-            .replace(QLatin1String(":"), QLatin1String("-"));
-    return res;
+// add the parsed pattern in a correct format for the filesystem
+QString FileNameHandler::sanitize(QString name)
+{
+    return name.replace(QLatin1String("/"), QStringLiteral("⁄"))
+      .replace(QLatin1String(":"), QLatin1String("-"));
 }
 
 /**
@@ -65,20 +135,29 @@ QString FileNameHandler::parseFilename(const QString& name)
  * - If `format` is not given, the suffix will remain untouched, unless `path`
  *   has no suffix, in which case it will be given the "png" suffix
  * - If the path generated by the previous steps points to an existing file,
- *   "_NUM" will be appended to its base name, where NUM is the first
- * available number that produces a non-existent path (starting from 1).
+ *   "_NUM" will be appended to its base name, where NUM is one more than the
+ *   highest number already used in the directory (starting from 1).
+ * - If `reserve` is true an empty file is created at the returned path, so a
+ *   concurrent save can't pick the same name.
  * @param path Possibly incomplete file name to transform
  * @param format Desired output file suffix (excluding an initial '.' character)
+ * @param reserve Create the file atomically before returning its path
+ * @param context Values of the capture specific tokens of the pattern
  */
 QString FileNameHandler::properScreenshotPath(QString path,
-                                              const QString& format)
+                                              const QString& format,
+                                              bool reserve,
+                                              const FilenameContext& context)
 {
     QFileInfo info(path);
     QString suffix = info.suffix();
 
     if (info.isDir()) {
         // path is a directory => generate filename from configured pattern
-        path = QDir(QDir(path).absolutePath() + "/" + parsedPattern()).path();
+        // only a reserved name takes a number from %{counter}
+        path = QDir(QDir(path).absolutePath() + "/" +
+                    formatPattern(context, reserve))
+                 .path();
     } else {
         // path points to a file => strip it of its suffix for now
         path = QDir(info.dir().absolutePath() + "/" + info.completeBaseName())
@@ -95,14 +174,30 @@ QString FileNameHandler::properScreenshotPath(QString path,
         path += ".png";
     }
 
-    if (!QFileInfo::exists(path)) {
+    if (reserve ? reservePath(path) : !QFileInfo::exists(path)) {
+        return path;
+    } else if (!QFileInfo::exists(path)) {
+        // The file can't be created at all, another number won't help.
+        // Saving to this path reports why.
         return path;
     } else {
-        return autoNumerateDuplicate(path);
+        return autoNumerateDuplicate(path, reserve);
     }
 }
 
-QString FileNameHandler::autoNumerateDuplicate(const QString& path)
+namespace {
+// Highest "_NUM" suffix handed out for every directory and base name, so
+// that saving into a directory full of captures doesn't need to probe every
+// number. Only a hint: numbers taken behind our back are skipped when
+// reserving the file.
+QHash<QString, int> duplicateNumbers;
+
+// Conflicts tolerated before the directory is scanned again
+constexpr int MAX_CONFLICTS = 16;
+}
+
+QString FileNameHandler::autoNumerateDuplicate(const QString& path,
+                                               bool reserve)
 {
     // add numeration in case of repeated filename in the directory
     // find unused name adding _n where n is a number
@@ -113,18 +208,79 @@ QString FileNameHandler::autoNumerateDuplicate(const QString& path)
     if (!suffix.isEmpty()) {
         suffix = QStringLiteral(".") + suffix;
     }
-    if (checkFile.exists()) {
-        filename += QLatin1String("_");
-        int i = 1;
-        while (true) {
-            checkFile.setFile(directory + "/" + filename + QString::number(i) +
-                              suffix);
-            if (!checkFile.exists()) {
-                filename += QString::number(i);
-                break;
+
+    QString key = directory + "/" + filename + suffix;
+    int conflicts = 0;
+    while (true) {
+        int number;
+        {
+            QMutexLocker locker(&namesMutex);
+            if (!duplicateNumbers.contains(key) ||
+                conflicts == MAX_CONFLICTS) {
+                duplicateNumbers[key] =
+                  highestDuplicateNumber(directory, filename, suffix);
+                conflicts = 0;
             }
-            ++i;
+            number = ++duplicateNumbers[key];
+        }
+        QString candidate = directory + "/" + filename + "_" +
+                            QString::number(number) + suffix;
+        if (reserve ? reservePath(candidate)
+                    : !QFileInfo::exists(candidate)) {
+            return candidate;
+        }
+        if (!QFileInfo::exists(candidate)) {
+            // The file can't be created at all, let saving report the error
+            return candidate;
+        }
+        ++conflicts;
+    }
+}
+
+/**
+ * @brief Find the highest NUM of the files named `baseName`_NUM`suffix` with
+ * a single listing of `directory`.
+ */
+int FileNameHandler::highestDuplicateNumber(const QString& directory,
+                                            const QString& baseName,
+                                            const QString& suffix)
+{
+    const QString prefix = baseName + "_";
+    int highest = 0;
+    const QStringList entries =
+      QDir(directory).entryList(QDir::Files | QDir::Hidden, QDir::NoSort);
+    for (const QString& entry : entries) {
+        if (entry.size() <= prefix.size() + suffix.size() ||
+            !entry.startsWith(prefix) || !entry.endsWith(suffix)) {
+            continue;
+        }
+        QStringRef digits = entry.midRef(
+          prefix.size(), entry.size() - prefix.size() - suffix.size());
+        bool ok = false;
+        int number = digits.toInt(&ok);
+        if (ok && number > highest && !digits.startsWith('+') &&
+            !digits.startsWith('-')) {
+            highest = number;
         }
     }
-    return checkFile.filePath();
+    return highest;
+}
+
+/**
+ * @brief Create an empty file at `path`, failing if it already exists.
+ */
+bool FileNameHandler::reservePath(const QString& path)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 11, 0)
+    // NewOnly opens the file with O_EXCL, the check and the creation are a
+    // single atomic operation
+    QFile file(path);
+    return file.open(QIODevice::WriteOnly | QIODevice::NewOnly);
+#else
+    if (QFileInfo::exists(path)) {
+        return false;
+    }
+    QFile file(path);
+    return file.open(QIODevice::WriteOnly);
+#endif
 }
@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include "filenameformatter.h"
 #include <QObject>
 
 class FileNameHandler : public QObject
@@ -11,14 +12,27 @@ class FileNameHandler : public QObject
 public:
     explicit FileNameHandler(QObject* parent = nullptr);
 
-    QString parsedPattern();
+    QString parsedPattern(FilenameContext context = FilenameContext());
     QString parseFilename(const QString& name);
 
-    QString properScreenshotPath(QString filename,
-                                 const QString& format = QString());
+    QString properScreenshotPath(
+      QString filename,
+      const QString& format = QString(),
+      bool reserve = true,
+      const FilenameContext& context = FilenameContext());
+
+    static void invalidatePattern();
 
     static const int MAX_CHARACTERS = 70;
 
 private:
-    QString autoNumerateDuplicate(const QString& path);
+    static QString formatPattern(FilenameContext context, bool takeCounter);
+    static const FilenameFormatter& configuredPattern();
+    static QString sanitize(QString name);
+
+    QString autoNumerateDuplicate(const QString& path, bool reserve);
+    static int highestDuplicateNumber(const QString& directory,
+                                      const QString& baseName,
+                                      const QString& suffix);
+    static bool reservePath(const QString& path);
 };
@@ -0,0 +1,166 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "fontfamilyindex.h"
+#include "src/config/cacheutils.h"
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QFontDatabase>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThread>
+
+namespace {
+const quint32 CACHE_MAGIC = 0x464c4646; // "FLFF"
+const qint32 CACHE_VERSION = 1;
+}
+
+class FontFamilyScanner : public QThread
+{
+public:
+    void run() override
+    {
+        // Take the stamps first, anything changing during the scan will
+        // trigger another one
+        stamps = FontFamilyIndex::directoryStamps();
+        families = QFontDatabase().families();
+        FontFamilyIndex::writeCache(stamps, families);
+    }
+
+    FontFamilyIndex::DirectoryStamps stamps;
+    QStringList families;
+};
+
+FontFamilyIndex* FontFamilyIndex::instance()
+{
+    static FontFamilyIndex index;
+    return &index;
+}
+
+FontFamilyIndex::FontFamilyIndex()
+  : m_loaded(false)
+  , m_refreshing(false)
+{}
+
+void FontFamilyIndex::load()
+{
+    if (m_loaded || m_refreshing) {
+        return;
+    }
+    DirectoryStamps cachedStamps;
+    QStringList cachedFamilies;
+    if (readCache(cachedStamps, cachedFamilies)) {
+        // Outdated families are better than none until the refresh is done
+        m_families = cachedFamilies;
+        if (cachedStamps == directoryStamps()) {
+            m_loaded = true;
+            return;
+        }
+    }
+
+    m_refreshing = true;
+    auto* scanner = new FontFamilyScanner();
+    connect(scanner, &QThread::finished, this, [this, scanner]() {
+        m_refreshing = false;
+        m_loaded = true;
+        m_families = scanner->families;
+        emit updated();
+    });
+    connect(scanner, &QThread::finished, scanner, &QObject::deleteLater);
+    scanner->start(QThread::LowPriority);
+}
+
+bool FontFamilyIndex::isRefreshing() const
+{
+    return m_refreshing;
+}
+
+const QStringList& FontFamilyIndex::families() const
+{
+    return m_families;
+}
+
+// Directories whose modification time changes with the installed fonts
+QStringList FontFamilyIndex::directories()
+{
+    QStringList candidates =
+      QStandardPaths::standardLocations(QStandardPaths::FontsLocation);
+#if defined(Q_OS_UNIX) && !defined(Q_OS_MACOS)
+    const QString home = QDir::homePath();
+    candidates << home + "/.fonts" << home + "/.local/share/fonts"
+               << QStringLiteral("/usr/share/fonts")
+               << QStringLiteral("/usr/local/share/fonts");
+    // Rewritten by fc-cache and by changes to the fontconfig configuration
+    candidates << QStandardPaths::writableLocation(
+                    QStandardPaths::GenericCacheLocation) +
+                    "/fontconfig"
+               << QStandardPaths::writableLocation(
+                    QStandardPaths::GenericConfigLocation) +
+                    "/fontconfig"
+               << QStringLiteral("/var/cache/fontconfig")
+               << QStringLiteral("/etc/fonts")
+               << QStringLiteral("/etc/fonts/conf.d");
+#endif
+
+    QStringList res;
+    for (const QString& dir : qAsConst(candidates)) {
+        QString path = QDir::cleanPath(dir);
+        if (!res.contains(path)) {
+            res << path;
+        }
+    }
+    return res;
+}
+
+QString FontFamilyIndex::cacheFile()
+{
+    return getCachePath() + "/fontfamilies.cache";
+}
+
+FontFamilyIndex::DirectoryStamps FontFamilyIndex::directoryStamps()
+{
+    DirectoryStamps stamps;
+    for (const QString& dir : directories()) {
+        QFileInfo info(dir);
+        // A missing directory has to invalidate the cache once created
+        qint64 modified =
+          info.exists() ? info.lastModified().toMSecsSinceEpoch() : -1;
+        stamps << qMakePair(dir, modified);
+    }
+    return stamps;
+}
+
+bool FontFamilyIndex::readCache(DirectoryStamps& stamps, QStringList& families)
+{
+    QFile file(cacheFile());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_9);
+    quint32 magic;
+    qint32 version;
+    in >> magic >> version;
+    if (magic != CACHE_MAGIC || version != CACHE_VERSION) {
+        return false;
+    }
+    in >> stamps >> families;
+    return in.status() == QDataStream::Ok;
+}
+
+void FontFamilyIndex::writeCache(const DirectoryStamps& stamps,
+                                 const QStringList& families)
+{
+    // Readers never see a partially written cache
+    QSaveFile file(cacheFile());
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_9);
+    out << CACHE_MAGIC << CACHE_VERSION << stamps << families;
+    file.commit();
+}
@@ -0,0 +1,54 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QObject>
+#include <QPair>
+#include <QStringList>
+#include <QVector>
+
+// Font families of the system, for the text tool.
+//
+// Enumerating the families with QFontDatabase takes seconds with thousands
+// of fonts installed. The families are stored in a binary file in the cache
+// directory together with the modification time of the font and fontconfig
+// directories, which change when fonts are installed or removed and when
+// fc-cache runs. When the cache is missing or outdated the families are
+// enumerated again in a background thread and updated() is emitted once
+// they are ready. The daemon loads the index when it starts, so the text
+// tool finds the families ready.
+class FontFamilyIndex : public QObject
+{
+    Q_OBJECT
+public:
+    static FontFamilyIndex* instance();
+
+    // Load the cached families, a refresh is started when they are outdated.
+    // Does nothing once the families are loaded.
+    void load();
+    bool isRefreshing() const;
+
+    const QStringList& families() const;
+
+signals:
+    void updated();
+
+private:
+    using DirectoryStamps = QVector<QPair<QString, qint64>>;
+
+    FontFamilyIndex();
+
+    static QStringList directories();
+    static QString cacheFile();
+    static DirectoryStamps directoryStamps();
+    static bool readCache(DirectoryStamps& stamps, QStringList& families);
+    static void writeCache(const DirectoryStamps& stamps,
+                           const QStringList& families);
+
+    QStringList m_families;
+    bool m_loaded;
+    bool m_refreshing;
+
+    friend class FontFamilyScanner;
+};
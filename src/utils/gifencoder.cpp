@@ -0,0 +1,328 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "gifencoder.h"
+#include <QIODevice>
+#include <cstring>
+
+// The last palette index is left for the unchanged pixels
+#define MAX_COLORS 255
+#define TRANSPARENT_INDEX 255
+// Mean squared distance of the changed pixels to their palette color above
+// which a new palette is made
+#define MAX_MEAN_ERROR 400
+// Durations are in hundredths of a second, most viewers show shorter frames
+// for a tenth of a second
+#define MIN_DELAY 2
+#define MAX_DELAY 65535
+
+#define LZW_MIN_CODE_SIZE 8
+#define LZW_MAX_CODE_BITS 12
+#define CLEAR_CODE (1 << LZW_MIN_CODE_SIZE)
+#define EOI_CODE (CLEAR_CODE + 1)
+// Open addressing table of the LZW strings, the classic GIF encoder sizes
+#define HASH_SIZE 5003
+#define HASH_SHIFT 4
+
+namespace {
+void appendShort(QByteArray& bytes, int value)
+{
+    bytes.append(static_cast<char>(value & 0xff));
+    bytes.append(static_cast<char>((value >> 8) & 0xff));
+}
+
+// Color tables always have 256 entries, the LZW code size is the same for
+// every frame then
+void appendPalette(QByteArray& bytes, const QVector<QRgb>& palette)
+{
+    for (int i = 0; i < 256; ++i) {
+        QRgb color = i < palette.size() ? palette[i] : 0;
+        bytes.append(static_cast<char>(qRed(color)));
+        bytes.append(static_cast<char>(qGreen(color)));
+        bytes.append(static_cast<char>(qBlue(color)));
+    }
+}
+}
+
+GifEncoder::GifEncoder(QIODevice* device)
+  : m_device(device)
+  , m_writtenTime(0)
+  , m_frameCount(0)
+{}
+
+bool GifEncoder::addFrame(const QImage& frame, qint64 timestamp)
+{
+    QImage image = frame.convertToFormat(QImage::Format_RGB32);
+    if (!m_pending.isNull()) {
+        if (image.size() != m_pending.size()) {
+            return false;
+        }
+        if (changedRect(m_pending, image).isEmpty()) {
+            return true;
+        }
+        if (!writePending(timestamp)) {
+            return false;
+        }
+    }
+    m_pending = image;
+    return true;
+}
+
+bool GifEncoder::finish(qint64 timestamp)
+{
+    if (m_pending.isNull() || !writePending(timestamp)) {
+        return false;
+    }
+    m_pending = QImage();
+    return write(QByteArray(1, ';'));
+}
+
+int GifEncoder::frameCount() const
+{
+    return m_frameCount;
+}
+
+bool GifEncoder::writePending(qint64 until)
+{
+    const QRect rect = m_shown.isNull() ? m_pending.rect()
+                                        : changedRect(m_shown, m_pending);
+    if (rect.isEmpty()) {
+        return true;
+    }
+    QByteArray indexes;
+    if (m_quantizer.palette().isEmpty() || !mapPixels(rect, indexes)) {
+        m_quantizer = ColorQuantizer(
+          ColorQuantizer::medianCut(m_pending, MAX_COLORS, rect));
+        mapPixels(rect, indexes);
+    }
+    if (m_frameCount == 0 &&
+        !writeHeader(m_pending.size(), m_quantizer.palette())) {
+        return false;
+    }
+
+    // Rounded where the frame ends, the rounding errors don't add up
+    const qint64 end = qMax((until + 5) / 10, m_writtenTime + MIN_DELAY);
+    const int delay =
+      static_cast<int>(qMin<qint64>(end - m_writtenTime, MAX_DELAY));
+    if (!writeFrame(rect,
+                    indexes,
+                    m_quantizer.palette() != m_globalPalette,
+                    delay)) {
+        return false;
+    }
+    m_writtenTime += delay;
+    m_shown = m_pending;
+    ++m_frameCount;
+    return true;
+}
+
+bool GifEncoder::writeHeader(const QSize& size, const QVector<QRgb>& palette)
+{
+    QByteArray header("GIF89a");
+    appendShort(header, size.width());
+    appendShort(header, size.height());
+    // Global color table of 256 colors, 8 bits per channel
+    header.append(static_cast<char>(0xf7));
+    header.append('\0');
+    header.append('\0');
+    appendPalette(header, palette);
+    // Loops forever
+    header.append("\x21\xff\x0bNETSCAPE2.0\x03\x01\x00\x00\x00", 19);
+    m_globalPalette = palette;
+    return write(header);
+}
+
+bool GifEncoder::writeFrame(const QRect& rect,
+                            const QByteArray& indexes,
+                            bool localPalette,
+                            int delay)
+{
+    QByteArray frame;
+    // Graphic control extension: the frame is drawn over the previous one,
+    // through its transparent pixels
+    frame.append("\x21\xf9\x04\x05", 4);
+    appendShort(frame, delay);
+    frame.append(static_cast<char>(TRANSPARENT_INDEX));
+    frame.append('\0');
+
+    frame.append(',');
+    appendShort(frame, rect.x());
+    appendShort(frame, rect.y());
+    appendShort(frame, rect.width());
+    appendShort(frame, rect.height());
+    frame.append(localPalette ? static_cast<char>(0x87) : '\0');
+    if (localPalette) {
+        appendPalette(frame, m_quantizer.palette());
+    }
+    frame.append(static_cast<char>(LZW_MIN_CODE_SIZE));
+    frame.append(compress(indexes));
+    return write(frame);
+}
+
+/**
+ * @brief Palette indexes of the pixels of the pending frame in `rect`, the
+ * pixels that are shown already are transparent. Returns false when the
+ * palette is too far from the colors of the other pixels.
+ */
+bool GifEncoder::mapPixels(const QRect& rect, QByteArray& indexes)
+{
+    indexes.resize(rect.width() * rect.height());
+    char* out = indexes.data();
+    const QVector<QRgb>& palette = m_quantizer.palette();
+    qint64 error = 0, mapped = 0;
+    for (int y = rect.top(); y <= rect.bottom(); ++y) {
+        const auto* line =
+          reinterpret_cast<const QRgb*>(m_pending.constScanLine(y));
+        const auto* shown =
+          m_shown.isNull()
+            ? nullptr
+            : reinterpret_cast<const QRgb*>(m_shown.constScanLine(y));
+        for (int x = rect.left(); x <= rect.right(); ++x) {
+            if (shown != nullptr && shown[x] == line[x]) {
+                *out++ = static_cast<char>(TRANSPARENT_INDEX);
+                continue;
+            }
+            const int index = m_quantizer.nearest(line[x]);
+            *out++ = static_cast<char>(index);
+            error += ColorQuantizer::distance(line[x], palette[index]);
+            ++mapped;
+        }
+    }
+    return error <= MAX_MEAN_ERROR * mapped;
+}
+
+bool GifEncoder::write(const QByteArray& bytes)
+{
+    return m_device->write(bytes) == bytes.size();
+}
+
+QRect GifEncoder::changedRect(const QImage& before, const QImage& after)
+{
+    const int width = after.width();
+    auto sameRow = [&](int y) {
+        return std::memcmp(before.constScanLine(y),
+                           after.constScanLine(y),
+                           width * sizeof(QRgb)) == 0;
+    };
+    int top = 0, bottom = after.height() - 1;
+    while (top <= bottom && sameRow(top)) {
+        ++top;
+    }
+    if (top > bottom) {
+        return QRect();
+    }
+    while (sameRow(bottom)) {
+        --bottom;
+    }
+
+    int left = width, right = -1;
+    for (int y = top; y <= bottom; ++y) {
+        const auto* a = reinterpret_cast<const QRgb*>(before.constScanLine(y));
+        const auto* b = reinterpret_cast<const QRgb*>(after.constScanLine(y));
+        for (int x = 0; x < left; ++x) {
+            if (a[x] != b[x]) {
+                left = x;
+                break;
+            }
+        }
+        for (int x = width - 1; x > right; --x) {
+            if (a[x] != b[x]) {
+                right = x;
+                break;
+            }
+        }
+    }
+    return QRect(QPoint(left, top), QPoint(right, bottom));
+}
+
+/**
+ * @brief LZW compressed `indexes`, in data sub-blocks and with the block
+ * terminator. The codes grow from 9 to 12 bits, the table is cleared once
+ * it has 4096 strings.
+ */
+QByteArray GifEncoder::compress(const QByteArray& indexes)
+{
+    QByteArray out, block;
+    quint32 accumulator = 0;
+    int bits = 0;
+    int codeSize = LZW_MIN_CODE_SIZE + 1;
+    int maxCode = (1 << codeSize) - 1;
+    int nextCode = EOI_CODE + 1;
+    bool cleared = false;
+
+    auto flush = [&]() {
+        if (!block.isEmpty()) {
+            out.append(static_cast<char>(block.size()));
+            out.append(block);
+            block.clear();
+        }
+    };
+    auto output = [&](int code) {
+        accumulator |= static_cast<quint32>(code) << bits;
+        bits += codeSize;
+        while (bits >= 8) {
+            block.append(static_cast<char>(accumulator & 0xff));
+            accumulator >>= 8;
+            bits -= 8;
+            if (block.size() == 255) {
+                flush();
+            }
+        }
+        // Same as the decoder, which widens the codes once its table has
+        // filled the current width
+        if (cleared) {
+            codeSize = LZW_MIN_CODE_SIZE + 1;
+            maxCode = (1 << codeSize) - 1;
+            cleared = false;
+        } else if (nextCode > maxCode && codeSize < LZW_MAX_CODE_BITS) {
+            ++codeSize;
+            maxCode = (1 << codeSize) - 1;
+        }
+    };
+
+    QVector<int> keys(HASH_SIZE, -1);
+    QVector<int> codes(HASH_SIZE);
+    const auto* pixels = reinterpret_cast<const uchar*>(indexes.constData());
+    output(CLEAR_CODE);
+    int prefix = pixels[0];
+    for (int p = 1; p < indexes.size(); ++p) {
+        const int c = pixels[p];
+        const int key = (c << LZW_MAX_CODE_BITS) + prefix;
+        int i = (c << HASH_SHIFT) ^ prefix;
+        const int step = i == 0 ? 1 : HASH_SIZE - i;
+        bool found = false;
+        while (keys[i] >= 0) {
+            if (keys[i] == key) {
+                found = true;
+                break;
+            }
+            i -= step;
+            if (i < 0) {
+                i += HASH_SIZE;
+            }
+        }
+        if (found) {
+            prefix = codes[i];
+            continue;
+        }
+        output(prefix);
+        prefix = c;
+        if (nextCode < (1 << LZW_MAX_CODE_BITS)) {
+            codes[i] = nextCode++;
+            keys[i] = key;
+        } else {
+            keys.fill(-1);
+            nextCode = EOI_CODE + 1;
+            cleared = true;
+            output(CLEAR_CODE);
+        }
+    }
+    output(prefix);
+    output(EOI_CODE);
+    if (bits > 0) {
+        block.append(static_cast<char>(accumulator & 0xff));
+    }
+    flush();
+    out.append('\0');
+    return out;
+}
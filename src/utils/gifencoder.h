@@ -0,0 +1,52 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include "colorquantizer.h"
+#include <QImage>
+
+class QIODevice;
+
+// Writes an animated GIF, frame by frame, as the frames come.
+//
+// Only the rectangle that changed since the previous frame is written, and
+// its pixels that did not change are transparent so they compress to almost
+// nothing. A frame identical to the previous one only makes it last longer.
+// The palette is kept from frame to frame as long as the changed pixels
+// stay close to it, a new one is made for the frame otherwise.
+class GifEncoder
+{
+public:
+    explicit GifEncoder(QIODevice* device);
+
+    // `timestamp` is in milliseconds since the start of the animation. The
+    // frames must have the same size.
+    bool addFrame(const QImage& frame, qint64 timestamp);
+    // Shows the last frame until `timestamp` and ends the file
+    bool finish(qint64 timestamp);
+    int frameCount() const;
+
+private:
+    bool writePending(qint64 until);
+    bool writeHeader(const QSize& size, const QVector<QRgb>& palette);
+    bool writeFrame(const QRect& rect,
+                    const QByteArray& indexes,
+                    bool localPalette,
+                    int delay);
+    bool mapPixels(const QRect& rect, QByteArray& indexes);
+    bool write(const QByteArray& bytes);
+    static QRect changedRect(const QImage& before, const QImage& after);
+    static QByteArray compress(const QByteArray& indexes);
+
+    QIODevice* m_device;
+    ColorQuantizer m_quantizer;
+    QVector<QRgb> m_globalPalette;
+    // Last frame written and the one waiting for its duration
+    QImage m_shown;
+    QImage m_pending;
+    qint64 m_pendingStart;
+    // Duration of the written frames, in hundredths of a second
+    qint64 m_writtenTime;
+    int m_frameCount;
+};
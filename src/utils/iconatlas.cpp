@@ -0,0 +1,284 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "iconatlas.h"
+#include "src/config/cacheutils.h"
+#include <QApplication>
+#include <QDataStream>
+#include <QFile>
+#include <QIconEngine>
+#include <QPainter>
+#include <QSaveFile>
+#include <QStyle>
+#include <QStyleOption>
+#include <QSvgRenderer>
+#include <QTimer>
+#include <utility>
+
+#define ATLAS_WIDTH 512
+// Delay before the new icons are saved, the toolbar asks for all its icons
+// in a row
+#define SAVE_DELAY_MS 2000
+
+namespace {
+const quint32 CACHE_MAGIC = 0x1C0A7145;
+const qint32 CACHE_VERSION = 1;
+
+// Asks the atlas for its pixmaps instead of rendering the SVG file
+class AtlasIconEngine : public QIconEngine
+{
+public:
+    explicit AtlasIconEngine(QString path)
+      : m_path(std::move(path))
+    {}
+
+    void paint(QPainter* painter,
+               const QRect& rect,
+               QIcon::Mode mode,
+               QIcon::State state) override
+    {
+        Q_UNUSED(state)
+        qreal ratio = painter->device()->devicePixelRatioF();
+        IconAtlas::instance()->paint(
+          painter, rect, m_path, rect.size() * ratio, mode);
+    }
+
+    QPixmap pixmap(const QSize& size,
+                   QIcon::Mode mode,
+                   QIcon::State state) override
+    {
+        Q_UNUSED(state)
+        return IconAtlas::instance()->pixmap(m_path, size, mode);
+    }
+
+    QIconEngine* clone() const override { return new AtlasIconEngine(m_path); }
+
+    QString key() const override { return QStringLiteral("IconAtlas"); }
+
+private:
+    QString m_path;
+};
+}
+
+uint qHash(const IconAtlas::Key& key, uint seed)
+{
+    return qHash(key.path, seed) ^ qHash(key.size.width(), seed) ^
+           qHash(key.size.height() << 16 | key.mode, seed);
+}
+
+QIcon IconAtlas::icon(const QString& path)
+{
+    return QIcon(new AtlasIconEngine(path));
+}
+
+IconAtlas* IconAtlas::instance()
+{
+    static IconAtlas atlas;
+    return &atlas;
+}
+
+IconAtlas::IconAtlas()
+  : m_shelfHeight(0)
+  , m_saveScheduled(false)
+{
+    readCache();
+}
+
+QPixmap IconAtlas::pixmap(const QString& path,
+                          const QSize& size,
+                          QIcon::Mode mode)
+{
+    if (size.isEmpty()) {
+        return QPixmap();
+    }
+    const Key key{ path, size, mode };
+    QRect rect = entry(key);
+    if (rect.isNull()) {
+        return QPixmap::fromImage(render(path, size, mode));
+    }
+    return m_atlas.copy(rect);
+}
+
+void IconAtlas::paint(QPainter* painter,
+                      const QRect& target,
+                      const QString& path,
+                      const QSize& size,
+                      QIcon::Mode mode)
+{
+    if (size.isEmpty()) {
+        return;
+    }
+    const Key key{ path, size, mode };
+    QRect rect = entry(key);
+    if (rect.isNull()) {
+        painter->drawImage(target, render(path, size, mode));
+    } else {
+        painter->drawPixmap(target, m_atlas, rect);
+    }
+}
+
+QRect IconAtlas::entry(const Key& key)
+{
+    auto rect = m_rects.constFind(key);
+    if (rect != m_rects.cend()) {
+        return rect.value();
+    }
+    QImage image = render(key.path, key.size, QIcon::Mode(key.mode));
+    QRect place = allocate(image.size());
+    if (!place.isNull()) {
+        QPainter painter(&m_atlas);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        painter.drawImage(place.topLeft(), image);
+        m_rects.insert(key, place);
+        scheduleSave();
+    }
+    return place;
+}
+
+QImage IconAtlas::render(const QString& path,
+                         const QSize& size,
+                         QIcon::Mode mode)
+{
+    QSvgRenderer renderer(path);
+    QSize actualSize = renderer.defaultSize();
+    if (actualSize.isEmpty()) {
+        actualSize = size;
+    } else {
+        actualSize.scale(size, Qt::KeepAspectRatio);
+    }
+    QImage image(actualSize, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    {
+        QPainter painter(&image);
+        renderer.render(&painter);
+    }
+    if (mode != QIcon::Normal) {
+        // Same as the disabled, active and selected icons of QIcon
+        QStyleOption option(0);
+        option.palette = QGuiApplication::palette();
+        QPixmap generated = QApplication::style()->generatedIconPixmap(
+          mode, QPixmap::fromImage(image), &option);
+        image = generated.toImage().convertToFormat(
+          QImage::Format_ARGB32_Premultiplied);
+    }
+    return image;
+}
+
+/**
+ * @brief Place for an image of `size` in the atlas, the atlas grows when it
+ * is full. Returns a null rect for an image wider than the atlas.
+ */
+QRect IconAtlas::allocate(const QSize& size)
+{
+    if (size.width() > ATLAS_WIDTH) {
+        return QRect();
+    }
+    if (m_cursor.x() + size.width() > ATLAS_WIDTH) {
+        m_cursor = QPoint(0, m_cursor.y() + m_shelfHeight);
+        m_shelfHeight = 0;
+    }
+    const int bottom = m_cursor.y() + size.height();
+    if (m_atlas.isNull() || bottom > m_atlas.height()) {
+        QPixmap grown(ATLAS_WIDTH, qMax(bottom, m_atlas.height() * 2));
+        grown.fill(Qt::transparent);
+        if (!m_atlas.isNull()) {
+            QPainter painter(&grown);
+            painter.setCompositionMode(QPainter::CompositionMode_Source);
+            painter.drawPixmap(0, 0, m_atlas);
+        }
+        m_atlas = grown;
+    }
+    QRect place(m_cursor, size);
+    m_cursor.rx() += size.width();
+    m_shelfHeight = qMax(m_shelfHeight, size.height());
+    return place;
+}
+
+void IconAtlas::scheduleSave()
+{
+    if (m_saveScheduled) {
+        return;
+    }
+    m_saveScheduled = true;
+    QTimer::singleShot(SAVE_DELAY_MS, [this]() {
+        m_saveScheduled = false;
+        writeCache();
+    });
+}
+
+QString IconAtlas::cacheFile()
+{
+    return getCachePath() + "/iconatlas.cache";
+}
+
+void IconAtlas::readCache()
+{
+    QFile file(cacheFile());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_9);
+    quint32 magic;
+    qint32 version;
+    QString appVersion;
+    in >> magic >> version;
+    if (magic != CACHE_MAGIC || version != CACHE_VERSION) {
+        return;
+    }
+    // The icons are compiled in, another version may have other icons
+    in >> appVersion;
+    if (appVersion != QStringLiteral(APP_VERSION)) {
+        return;
+    }
+
+    qint32 count, height, shelfHeight;
+    QPoint cursor;
+    in >> count >> cursor >> shelfHeight >> height;
+    QHash<Key, QRect> rects;
+    for (int i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        Key key;
+        QRect rect;
+        in >> key.path >> key.size >> key.mode >> rect;
+        rects.insert(key, rect);
+    }
+    if (in.status() != QDataStream::Ok || height <= 0) {
+        return;
+    }
+    // The pixels are stored raw, loading them is a single copy
+    QImage atlas(ATLAS_WIDTH, height, QImage::Format_ARGB32_Premultiplied);
+    const int bytes = atlas.bytesPerLine() * atlas.height();
+    if (in.readRawData(reinterpret_cast<char*>(atlas.bits()), bytes) !=
+        bytes) {
+        return;
+    }
+    m_atlas = QPixmap::fromImage(std::move(atlas));
+    m_rects = rects;
+    m_cursor = cursor;
+    m_shelfHeight = shelfHeight;
+}
+
+void IconAtlas::writeCache()
+{
+    if (m_atlas.isNull()) {
+        return;
+    }
+    const QImage atlas =
+      m_atlas.toImage().convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    QSaveFile file(cacheFile());
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_9);
+    out << CACHE_MAGIC << CACHE_VERSION << QStringLiteral(APP_VERSION);
+    out << static_cast<qint32>(m_rects.size()) << m_cursor
+        << static_cast<qint32>(m_shelfHeight)
+        << static_cast<qint32>(atlas.height());
+    for (auto it = m_rects.cbegin(); it != m_rects.cend(); ++it) {
+        out << it.key().path << it.key().size << it.key().mode << it.value();
+    }
+    out.writeRawData(reinterpret_cast<const char*>(atlas.constBits()),
+                     atlas.bytesPerLine() * atlas.height());
+    file.commit();
+}
@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QHash>
+#include <QIcon>
+#include <QImage>
+#include <QPixmap>
+#include <QRect>
+#include <QString>
+
+class QPainter;
+
+// Rasterized SVG icons of the interface, packed in one atlas pixmap.
+//
+// An icon is rendered once for every pixel size and mode it is painted at.
+// Only the atlas holds the pixels: icons are painted straight from it, and
+// the pixmaps asked for are short-lived copies of their part of it.
+// The color is part of the path (see PathInfo::whiteIconPath), and the
+// device pixel ratio is part of the pixel size, so both select their own
+// entry. The atlas lives as long as the process, which is the daemon for
+// the capture widget. It is also saved in the cache directory, so a new
+// process paints the toolbar without parsing any SVG file. All the calls
+// have to be made from the GUI thread.
+class IconAtlas
+{
+public:
+    // Drop-in replacement of QIcon(path) for an SVG icon
+    static QIcon icon(const QString& path);
+
+    static IconAtlas* instance();
+
+    QPixmap pixmap(const QString& path, const QSize& size, QIcon::Mode mode);
+    // Paint the icon of `size` pixels into `target`
+    void paint(QPainter* painter,
+               const QRect& target,
+               const QString& path,
+               const QSize& size,
+               QIcon::Mode mode);
+
+private:
+    struct Key
+    {
+        QString path;
+        QSize size;
+        int mode;
+
+        bool operator==(const Key& other) const
+        {
+            return path == other.path && size == other.size &&
+                   mode == other.mode;
+        }
+    };
+    friend uint qHash(const Key& key, uint seed);
+
+    IconAtlas();
+
+    // Part of the atlas holding the icon, null if it doesn't fit in it
+    QRect entry(const Key& key);
+    QImage render(const QString& path, const QSize& size, QIcon::Mode mode);
+    QRect allocate(const QSize& size);
+    void scheduleSave();
+    void readCache();
+    void writeCache();
+    static QString cacheFile();
+
+    QPixmap m_atlas;
+    QHash<Key, QRect> m_rects;
+    // Shelf packing: icons are placed left to right on the current shelf,
+    // a new shelf starts below the highest icon of the current one
+    QPoint m_cursor;
+    int m_shelfHeight;
+    bool m_saveScheduled;
+};
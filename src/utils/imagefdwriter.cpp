@@ -0,0 +1,73 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "imagefdwriter.h"
+#include "abstractlogger.h"
+#include "src/utils/metrics.h"
+#include <QFile>
+#include <QImageWriter>
+#include <QThreadPool>
+#include <csignal>
+#include <utility>
+
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#else
+#include <io.h>
+#endif
+
+ImageFdWriter::ImageFdWriter(QImage image, int fd, QByteArray format)
+  : m_image(std::move(image))
+  , m_fd(fd)
+  , m_format(std::move(format))
+{}
+
+QThreadPool* ImageFdWriter::pool()
+{
+    static QThreadPool* pool = []() {
+#ifdef Q_OS_UNIX
+        // A reader closing its end early must fail the write, not kill the
+        // daemon
+        std::signal(SIGPIPE, SIG_IGN);
+#endif
+        return new QThreadPool();
+    }();
+    return pool;
+}
+
+void ImageFdWriter::run()
+{
+    Metrics::Timer timer(QStringLiteral("captureToFd.") +
+                         QString::fromLatin1(m_format));
+    QFile file;
+    if (!file.open(m_fd, QIODevice::WriteOnly, QFileDevice::AutoCloseHandle)) {
+#ifdef Q_OS_UNIX
+        ::close(m_fd);
+#else
+        ::_close(m_fd);
+#endif
+        return;
+    }
+
+    bool ok = true;
+    if (m_format == "raw") {
+        QImage image = m_image.convertToFormat(QImage::Format_RGBA8888);
+        const qint64 rowSize = static_cast<qint64>(image.width()) * 4;
+        for (int y = 0; ok && y < image.height(); ++y) {
+            const auto* row =
+              reinterpret_cast<const char*>(image.constScanLine(y));
+            ok = file.write(row, rowSize) == rowSize;
+        }
+    } else {
+        QImageWriter writer(&file, m_format);
+        ok = writer.write(m_image);
+    }
+    if (!ok) {
+        AbstractLogger::error(AbstractLogger::LogFile | AbstractLogger::Stderr)
+          << QObject::tr("Unable to write the capture to the file "
+                         "descriptor: %1")
+               .arg(file.errorString());
+    }
+    Metrics::instance()->increment(ok ? QStringLiteral("fdCaptures")
+                                      : QStringLiteral("fdCaptureErrors"));
+}
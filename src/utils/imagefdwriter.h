@@ -0,0 +1,32 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QByteArray>
+#include <QImage>
+#include <QRunnable>
+
+class QThreadPool;
+
+// Writes a capture into a file descriptor owned by the writer, for the
+// captureToFd D-Bus method. The "raw" format writes the RGBA8888 pixels
+// row after row, any other format is encoded with QImageWriter straight
+// into the descriptor. The descriptor is closed when the writer is done, so
+// the reader of a pipe sees the end of the data.
+class ImageFdWriter : public QRunnable
+{
+public:
+    ImageFdWriter(QImage image, int fd, QByteArray format);
+
+    void run() override;
+
+    // Pool running the writers, separate from the global pool because a
+    // reader that is slow to drain its pipe keeps its writer waiting
+    static QThreadPool* pool();
+
+private:
+    QImage m_image;
+    int m_fd;
+    QByteArray m_format;
+};
@@ -0,0 +1,98 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "imagemimedata.h"
+#include "abstractlogger.h"
+#include "src/utils/confighandler.h"
+#include "src/utils/metrics.h"
+#include "src/utils/pngoptimizer.h"
+#include <QBuffer>
+#include <QImageWriter>
+
+namespace {
+const QString IMAGE_MIME_PREFIX = QStringLiteral("image/");
+const QString QT_IMAGE_MIME = QStringLiteral("application/x-qt-image");
+}
+
+ImageMimeData::ImageMimeData(const QImage& image,
+                             const QString& preferredType,
+                             bool onlyPreferred)
+  : m_image(image)
+  , m_onlyPreferred(onlyPreferred)
+  , m_encoded(CACHE_SIZE)
+{
+    QStringList candidates{ preferredType, "png", "jpeg", "bmp" };
+    if (onlyPreferred) {
+        candidates = QStringList{ preferredType };
+    }
+    QList<QByteArray> supported = QImageWriter::supportedImageFormats();
+    for (const QString& type : candidates) {
+        if (!m_imageTypes.contains(type) && supported.contains(type.toUtf8())) {
+            m_imageTypes << type;
+        }
+    }
+}
+
+QStringList ImageMimeData::formats() const
+{
+    QStringList result;
+    for (const QString& type : m_imageTypes) {
+        result << IMAGE_MIME_PREFIX + type;
+    }
+    if (!m_onlyPreferred) {
+        // Lets Qt convert to the native image formats of the platform
+        result << QT_IMAGE_MIME;
+    }
+    return result;
+}
+
+bool ImageMimeData::hasFormat(const QString& mimeType) const
+{
+    return formats().contains(mimeType);
+}
+
+QVariant ImageMimeData::retrieveData(const QString& mimeType,
+                                     QVariant::Type type) const
+{
+    if (mimeType == QT_IMAGE_MIME && !m_onlyPreferred) {
+        return m_image;
+    }
+    if (!mimeType.startsWith(IMAGE_MIME_PREFIX)) {
+        return QMimeData::retrieveData(mimeType, type);
+    }
+    QString imageType = mimeType.mid(IMAGE_MIME_PREFIX.size());
+    if (!m_imageTypes.contains(imageType)) {
+        return {};
+    }
+    if (QByteArray* cached = m_encoded.object(imageType)) {
+        return *cached;
+    }
+    QByteArray data = encode(imageType);
+    if (data.isEmpty()) {
+        AbstractLogger::error()
+          << QObject::tr("Error while saving to clipboard");
+        return {};
+    }
+    // Too big entries are simply not cached
+    m_encoded.insert(imageType, new QByteArray(data), data.size());
+    return data;
+}
+
+QByteArray ImageMimeData::encode(const QString& imageType) const
+{
+    Metrics::Timer timer(QStringLiteral("encode.") + imageType);
+    QByteArray array;
+    QBuffer buffer{ &array };
+    QImageWriter imageWriter{ &buffer, imageType.toUpper().toUtf8() };
+    if (imageType == "jpeg") {
+        imageWriter.setQuality(ConfigHandler().jpegQuality());
+    }
+    QImage image = m_image;
+    if (imageType == "png") {
+        image = PngOptimizer::forDestination(image, PngOptimizer::CLIPBOARD);
+    }
+    if (!imageWriter.write(image)) {
+        return {};
+    }
+    return array;
+}
@@ -0,0 +1,43 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QCache>
+#include <QImage>
+#include <QMimeData>
+#include <QStringList>
+
+// Clipboard content for a capture. Every image format we can write is
+// advertised, but the image is only encoded when a client actually pastes
+// that format. The encoded data is kept in a small LRU cache so pasting the
+// same format again doesn't encode the image again.
+class ImageMimeData : public QMimeData
+{
+    Q_OBJECT
+public:
+    // `preferredType` is the image type (e.g. "png") offered first. With
+    // `onlyPreferred` no other format is offered, not even to let Qt
+    // convert the image to the native formats.
+    explicit ImageMimeData(const QImage& image,
+                           const QString& preferredType = "png",
+                           bool onlyPreferred = false);
+
+    QStringList formats() const override;
+    bool hasFormat(const QString& mimeType) const override;
+
+    // Maximum size of the encoded data kept in the cache
+    static constexpr int CACHE_SIZE = 64 * 1024 * 1024;
+
+protected:
+    QVariant retrieveData(const QString& mimeType,
+                          QVariant::Type type) const override;
+
+private:
+    QByteArray encode(const QString& imageType) const;
+
+    QImage m_image;
+    QStringList m_imageTypes;
+    bool m_onlyPreferred;
+    mutable QCache<QString, QByteArray> m_encoded;
+};
@@ -0,0 +1,145 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "imagetilestore.h"
+#include <QPainter>
+
+void ImageTileStore::reset(const QPixmap& working)
+{
+    m_tiles.clear();
+    m_size = working.size();
+    m_devicePixelRatio = working.devicePixelRatio();
+    m_columns = (m_size.width() + TILE_SIZE - 1) / TILE_SIZE;
+    m_rows = (m_size.height() + TILE_SIZE - 1) / TILE_SIZE;
+}
+
+void ImageTileStore::clear()
+{
+    m_tiles.clear();
+}
+
+void ImageTileStore::preserve(const QPixmap& working, const QRegion& region)
+{
+    if (m_columns == 0 || working.size() != m_size) {
+        return;
+    }
+    for (const QRect& r : region) {
+        QRect deviceRect = toDeviceRect(r);
+        if (deviceRect.isEmpty()) {
+            continue;
+        }
+        for (int row = deviceRect.top() / TILE_SIZE;
+             row <= deviceRect.bottom() / TILE_SIZE;
+             ++row) {
+            for (int column = deviceRect.left() / TILE_SIZE;
+                 column <= deviceRect.right() / TILE_SIZE;
+                 ++column) {
+                int key = tileKey(column, row);
+                if (m_tiles.contains(key)) {
+                    continue;
+                }
+                QImage tile = working.copy(tileRect(column, row)).toImage();
+                tile.setDevicePixelRatio(1);
+                m_tiles.insert(key, tile);
+            }
+        }
+    }
+}
+
+void ImageTileStore::restore(QPainter& painter) const
+{
+    if (m_tiles.isEmpty()) {
+        return;
+    }
+    painter.save();
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform, false);
+    for (auto it = m_tiles.constBegin(); it != m_tiles.constEnd(); ++it) {
+        QRect r = tileRect(it.key() % m_columns, it.key() / m_columns);
+        painter.drawImage(toLogicalRect(r), it.value());
+    }
+    painter.restore();
+}
+
+QPixmap ImageTileStore::original(const QPixmap& working,
+                                 const QRect& rect) const
+{
+    QRect deviceRect = QRect(QPoint(0, 0), m_size);
+    if (!rect.isNull()) {
+        deviceRect = deviceRect.intersected(rect);
+    }
+    QPixmap result = working.copy(deviceRect);
+    if (m_tiles.isEmpty()) {
+        return result;
+    }
+    // paint in device pixels so the tiles are copied without any scaling
+    result.setDevicePixelRatio(1);
+    QPainter painter(&result);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    for (auto it = m_tiles.constBegin(); it != m_tiles.constEnd(); ++it) {
+        QRect r = tileRect(it.key() % m_columns, it.key() / m_columns);
+        if (r.intersects(deviceRect)) {
+            painter.drawImage(r.topLeft() - deviceRect.topLeft(), it.value());
+        }
+    }
+    painter.end();
+    result.setDevicePixelRatio(m_devicePixelRatio);
+    return result;
+}
+
+QRegion ImageTileStore::modifiedRegion() const
+{
+    QRegion region;
+    for (auto it = m_tiles.constBegin(); it != m_tiles.constEnd(); ++it) {
+        QRect r = tileRect(it.key() % m_columns, it.key() / m_columns);
+        region += toLogicalRect(r).toAlignedRect();
+    }
+    return region;
+}
+
+int ImageTileStore::tileCount() const
+{
+    return m_columns * m_rows;
+}
+
+int ImageTileStore::savedTileCount() const
+{
+    return m_tiles.size();
+}
+
+qint64 ImageTileStore::memoryUsage() const
+{
+    qint64 bytes = 0;
+    for (const QImage& tile : m_tiles) {
+        bytes += static_cast<qint64>(tile.bytesPerLine()) * tile.height();
+    }
+    return bytes;
+}
+
+int ImageTileStore::tileKey(int column, int row) const
+{
+    return row * m_columns + column;
+}
+
+QRect ImageTileStore::tileRect(int column, int row) const
+{
+    return QRect(column * TILE_SIZE, row * TILE_SIZE, TILE_SIZE, TILE_SIZE)
+      .intersected(QRect(QPoint(0, 0), m_size));
+}
+
+QRect ImageTileStore::toDeviceRect(const QRect& logicalRect) const
+{
+    QRectF r(logicalRect.x() * m_devicePixelRatio,
+             logicalRect.y() * m_devicePixelRatio,
+             logicalRect.width() * m_devicePixelRatio,
+             logicalRect.height() * m_devicePixelRatio);
+    return r.toAlignedRect().intersected(QRect(QPoint(0, 0), m_size));
+}
+
+QRectF ImageTileStore::toLogicalRect(const QRect& deviceRect) const
+{
+    return QRectF(deviceRect.x() / m_devicePixelRatio,
+                  deviceRect.y() / m_devicePixelRatio,
+                  deviceRect.width() / m_devicePixelRatio,
+                  deviceRect.height() / m_devicePixelRatio);
+}
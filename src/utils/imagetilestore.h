@@ -0,0 +1,56 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QHash>
+#include <QImage>
+#include <QPixmap>
+#include <QRegion>
+
+class QPainter;
+
+// Keeps the unmodified pixels of a screenshot while its working copy is being
+// annotated. The screenshot is divided into square tiles and a tile is copied
+// into the store only right before it is painted over for the first time.
+// Tiles that were never touched stay shared with the working pixmap, so the
+// memory cost is proportional to the annotated area instead of the screen.
+class ImageTileStore
+{
+public:
+    static constexpr int TILE_SIZE = 256;
+
+    // Start tracking a new working pixmap, all saved tiles are dropped
+    void reset(const QPixmap& working);
+    void clear();
+
+    // Save the original content of all the tiles of `working` intersecting
+    // `region` (logical coordinates) that were not saved yet. Must be called
+    // before painting into that region of the working pixmap.
+    void preserve(const QPixmap& working, const QRegion& region);
+    // Paint all the saved tiles back, reverting every modification made to
+    // the working pixmap since the last reset().
+    void restore(QPainter& painter) const;
+    // Unmodified screenshot area, `rect` is in device pixels like the one of
+    // QPixmap::copy(). A null rect returns the whole screenshot.
+    QPixmap original(const QPixmap& working, const QRect& rect = QRect()) const;
+
+    // Region covered by the saved tiles, in logical coordinates
+    QRegion modifiedRegion() const;
+    int tileCount() const;
+    int savedTileCount() const;
+    // Bytes held by the saved tiles
+    qint64 memoryUsage() const;
+
+private:
+    int tileKey(int column, int row) const;
+    QRect tileRect(int column, int row) const;
+    QRect toDeviceRect(const QRect& logicalRect) const;
+    QRectF toLogicalRect(const QRect& deviceRect) const;
+
+    QSize m_size;
+    qreal m_devicePixelRatio = 1;
+    int m_columns = 0;
+    int m_rows = 0;
+    QHash<int, QImage> m_tiles;
+};
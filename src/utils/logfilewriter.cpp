@@ -0,0 +1,153 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "logfilewriter.h"
+#include <QDir>
+#include <QFile>
+#include <QStandardPaths>
+#include <chrono>
+
+namespace {
+const QString LOG_FILE_NAME = QStringLiteral("flameshot.log");
+}
+
+LogFileWriter* LogFileWriter::instance()
+{
+    static LogFileWriter writer;
+    return &writer;
+}
+
+LogFileWriter::LogFileWriter()
+{
+    for (size_t i = 0; i < m_ring.size(); ++i) {
+        m_ring[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    m_thread = std::thread([this]() { run(); });
+}
+
+LogFileWriter::~LogFileWriter()
+{
+    m_stop = true;
+    m_wake.notify_one();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void LogFileWriter::append(const QByteArray& line)
+{
+    size_t pos = m_writePos.load(std::memory_order_relaxed);
+    while (true) {
+        Slot& slot = m_ring[pos % m_ring.size()];
+        size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<qint64>(sequence) - static_cast<qint64>(pos);
+        if (diff == 0) {
+            if (m_writePos.compare_exchange_weak(
+                  pos, pos + 1, std::memory_order_relaxed)) {
+                slot.line = line;
+                slot.sequence.store(pos + 1, std::memory_order_release);
+                // Without the mutex a wake up can be missed, the writer
+                // thread wakes up by itself soon anyway
+                m_wake.notify_one();
+                return;
+            }
+        } else if (diff < 0) {
+            // The ring is full, better lose a record than block
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        } else {
+            pos = m_writePos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool LogFileWriter::take(QByteArray& line)
+{
+    Slot& slot = m_ring[m_readPos % m_ring.size()];
+    size_t sequence = slot.sequence.load(std::memory_order_acquire);
+    if (sequence != m_readPos + 1) {
+        return false;
+    }
+    line = slot.line;
+    slot.line = QByteArray();
+    slot.sequence.store(m_readPos + m_ring.size(), std::memory_order_release);
+    ++m_readPos;
+    return true;
+}
+
+QString LogFileWriter::logDirectory()
+{
+#if defined(Q_OS_WIN) || defined(Q_OS_MACOS)
+    return QStandardPaths::writableLocation(
+             QStandardPaths::AppLocalDataLocation) +
+           "/logs";
+#else
+    QString stateHome = QString::fromLocal8Bit(qgetenv("XDG_STATE_HOME"));
+    if (stateHome.isEmpty() || QDir::isRelativePath(stateHome)) {
+        stateHome = QDir::homePath() + "/.local/state";
+    }
+    return stateHome + "/flameshot";
+#endif
+}
+
+void LogFileWriter::run()
+{
+    QFile file;
+    while (true) {
+        // Read the flag first so every record queued before stopping is
+        // written
+        const bool stop = m_stop;
+        bool written = false;
+        QByteArray line;
+        while (take(line)) {
+            if (!file.isOpen() && !openFile(file)) {
+                continue;
+            }
+            file.write(line);
+            file.write("\n");
+            written = true;
+            if (file.size() > MAX_FILE_SIZE) {
+                rotate(file);
+            }
+        }
+        quint64 dropped = m_dropped.exchange(0);
+        if (dropped > 0 && (file.isOpen() || openFile(file))) {
+            file.write(QByteArray("{\"dropped\":") +
+                       QByteArray::number(dropped) + "}\n");
+            written = true;
+        }
+        if (written) {
+            file.flush();
+        }
+        if (stop) {
+            break;
+        }
+        std::unique_lock<std::mutex> lock(m_wakeMutex);
+        m_wake.wait_for(lock, std::chrono::seconds(1));
+    }
+}
+
+bool LogFileWriter::openFile(QFile& file)
+{
+    QString dir = logDirectory();
+    if (!QDir().mkpath(dir)) {
+        return false;
+    }
+    file.setFileName(dir + "/" + LOG_FILE_NAME);
+    return file.open(QIODevice::WriteOnly | QIODevice::Append);
+}
+
+void LogFileWriter::rotate(QFile& file)
+{
+    // flameshot.log becomes flameshot.log.1, flameshot.log.1 becomes
+    // flameshot.log.2 and so on
+    file.close();
+    QString path = logDirectory() + "/" + LOG_FILE_NAME;
+    QFile::remove(path + "." + QString::number(ROTATED_FILES));
+    for (int i = ROTATED_FILES - 1; i >= 1; --i) {
+        QFile::rename(path + "." + QString::number(i),
+                      path + "." + QString::number(i + 1));
+    }
+    QFile::rename(path, path + ".1");
+    openFile(file);
+}
@@ -0,0 +1,63 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+class QFile;
+
+// Writer of the log file, used by the LogFile target of AbstractLogger.
+//
+// Records are pushed into a fixed size lock-free ring buffer and written by a
+// background thread, so logging never waits for the disk. When the ring is
+// full the record is dropped and counted instead of blocking the caller. The
+// file is rotated once it grows past MAX_FILE_SIZE.
+class LogFileWriter
+{
+public:
+    static LogFileWriter* instance();
+    ~LogFileWriter();
+
+    // Queue a line, it must not contain any line break
+    void append(const QByteArray& line);
+
+    // Directory of the log files, under $XDG_STATE_HOME on Linux
+    static QString logDirectory();
+
+    static constexpr int RING_SIZE = 1024;
+    static constexpr qint64 MAX_FILE_SIZE = 1024 * 1024;
+    static constexpr int ROTATED_FILES = 3;
+
+private:
+    LogFileWriter();
+
+    bool take(QByteArray& line);
+    void run();
+    bool openFile(QFile& file);
+    void rotate(QFile& file);
+
+    // Bounded multi-producer queue, see Dmitry Vyukov's MPMC queue. Every
+    // slot has a sequence number telling whether it can be written or read
+    // for the current round.
+    struct Slot
+    {
+        std::atomic<size_t> sequence;
+        QByteArray line;
+    };
+    std::array<Slot, RING_SIZE> m_ring;
+    std::atomic<size_t> m_writePos{ 0 };
+    size_t m_readPos = 0;
+    std::atomic<quint64> m_dropped{ 0 };
+
+    std::atomic<bool> m_stop{ false };
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+    std::thread m_thread;
+};
@@ -0,0 +1,182 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "metrics.h"
+#include <QFile>
+#include <QMutexLocker>
+#include <cmath>
+#include <utility>
+
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+namespace {
+// Resident memory of this process in bytes, -1 if unknown
+qint64 residentMemory()
+{
+#ifdef Q_OS_LINUX
+    QFile statm(QStringLiteral("/proc/self/statm"));
+    if (!statm.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+    QList<QByteArray> fields = statm.readAll().split(' ');
+    if (fields.size() < 2) {
+        return -1;
+    }
+    return fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE);
+#else
+    return -1;
+#endif
+}
+}
+
+Metrics* Metrics::instance()
+{
+    static Metrics metrics;
+    return &metrics;
+}
+
+Metrics::Metrics()
+{
+    m_uptime.start();
+}
+
+void Metrics::increment(const QString& counter, qint64 amount)
+{
+    QMutexLocker locker(&m_mutex);
+    m_counters[counter] += amount;
+}
+
+void Metrics::recordLatency(const QString& name, qint64 usecs)
+{
+    QMutexLocker locker(&m_mutex);
+    m_histograms[name].record(usecs);
+}
+
+void Metrics::setGauge(const QString& name,
+                       const std::function<qint64()>& read)
+{
+    QMutexLocker locker(&m_mutex);
+    m_gauges[name] = read;
+}
+
+/**
+ * @brief Current values of all the metrics. Latencies are in microseconds.
+ */
+QJsonObject Metrics::snapshot() const
+{
+    QJsonObject counters, latencies, gauges;
+    QHash<QString, std::function<qint64()>> gaugeReaders;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (auto it = m_counters.cbegin(); it != m_counters.cend(); ++it) {
+            counters[it.key()] = it.value();
+        }
+        for (auto it = m_histograms.cbegin(); it != m_histograms.cend();
+             ++it) {
+            latencies[it.key()] = it.value().toJson();
+        }
+        gaugeReaders = m_gauges;
+    }
+    // The readers may take their own locks, don't call them with ours
+    for (auto it = gaugeReaders.cbegin(); it != gaugeReaders.cend(); ++it) {
+        gauges[it.key()] = it.value()();
+    }
+    qint64 rss = residentMemory();
+    if (rss >= 0) {
+        gauges["residentMemory"] = rss;
+    }
+
+    QJsonObject metrics;
+    metrics["uptime"] = m_uptime.elapsed() / 1000;
+    metrics["counters"] = counters;
+    metrics["gauges"] = gauges;
+    metrics["latencies"] = latencies;
+    return metrics;
+}
+
+Metrics::Timer::Timer(QString name)
+  : m_name(std::move(name))
+{
+    m_timer.start();
+}
+
+Metrics::Timer::~Timer()
+{
+    Metrics::instance()->recordLatency(m_name, m_timer.nsecsElapsed() / 1000);
+}
+
+void Metrics::Histogram::record(qint64 value)
+{
+    value = qMax<qint64>(value, 0);
+    int index = bucketIndex(value);
+    if (index >= m_buckets.size()) {
+        m_buckets.resize(index + 1);
+    }
+    ++m_buckets[index];
+    if (m_count == 0 || value < m_min) {
+        m_min = value;
+    }
+    m_max = qMax(m_max, value);
+    m_sum += value;
+    ++m_count;
+}
+
+QJsonObject Metrics::Histogram::toJson() const
+{
+    QJsonObject json;
+    json["count"] = static_cast<qint64>(m_count);
+    json["min"] = m_min;
+    json["max"] = m_max;
+    json["mean"] = m_count > 0 ? m_sum / static_cast<qint64>(m_count) : 0;
+    json["p50"] = percentile(0.5);
+    json["p90"] = percentile(0.9);
+    json["p99"] = percentile(0.99);
+    json["p999"] = percentile(0.999);
+    return json;
+}
+
+int Metrics::Histogram::bucketIndex(qint64 value)
+{
+    const qint64 subBuckets = 1 << SUB_BUCKET_BITS;
+    if (value < subBuckets) {
+        return static_cast<int>(value);
+    }
+    int exponent = SUB_BUCKET_BITS;
+    while ((value >> (exponent + 1)) != 0) {
+        ++exponent;
+    }
+    int shift = exponent - SUB_BUCKET_BITS;
+    int subBucket = static_cast<int>((value >> shift) & (subBuckets - 1));
+    return static_cast<int>((shift + 1) * subBuckets) + subBucket;
+}
+
+qint64 Metrics::Histogram::bucketUpperBound(int index)
+{
+    const int subBuckets = 1 << SUB_BUCKET_BITS;
+    if (index < subBuckets) {
+        return index;
+    }
+    int shift = index / subBuckets - 1;
+    qint64 lowerBound = static_cast<qint64>(subBuckets + index % subBuckets)
+                        << shift;
+    return lowerBound + (qint64(1) << shift) - 1;
+}
+
+qint64 Metrics::Histogram::percentile(double fraction) const
+{
+    if (m_count == 0) {
+        return 0;
+    }
+    auto target = qMax<quint64>(
+      1, static_cast<quint64>(std::ceil(fraction * m_count)));
+    quint64 seen = 0;
+    for (int i = 0; i < m_buckets.size(); ++i) {
+        seen += m_buckets.at(i);
+        if (seen >= target) {
+            return qMin(bucketUpperBound(i), m_max);
+        }
+    }
+    return m_max;
+}
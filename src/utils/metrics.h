@@ -0,0 +1,71 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonObject>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+#include <functional>
+
+// Counters, gauges and latency histograms of this instance. The daemon
+// reports them through the getMetrics D-Bus method, see `flameshot stats`.
+class Metrics
+{
+public:
+    static Metrics* instance();
+
+    void increment(const QString& counter, qint64 amount = 1);
+    void recordLatency(const QString& name, qint64 usecs);
+    // `read` is called for the current value every time a snapshot is taken
+    void setGauge(const QString& name, const std::function<qint64()>& read);
+
+    QJsonObject snapshot() const;
+
+    // Records the time between its creation and its destruction
+    class Timer
+    {
+    public:
+        explicit Timer(QString name);
+        ~Timer();
+
+    private:
+        QString m_name;
+        QElapsedTimer m_timer;
+    };
+
+private:
+    Metrics();
+
+    // Log-linear histogram in the style of HdrHistogram: every power of two
+    // is split in 2^SUB_BUCKET_BITS buckets, so any recorded value is known
+    // within 1/2^SUB_BUCKET_BITS of its magnitude with a fixed memory cost.
+    class Histogram
+    {
+    public:
+        static constexpr int SUB_BUCKET_BITS = 3;
+
+        void record(qint64 value);
+        QJsonObject toJson() const;
+
+    private:
+        static int bucketIndex(qint64 value);
+        static qint64 bucketUpperBound(int index);
+        qint64 percentile(double fraction) const;
+
+        QVector<quint64> m_buckets;
+        quint64 m_count = 0;
+        qint64 m_sum = 0;
+        qint64 m_min = 0;
+        qint64 m_max = 0;
+    };
+
+    mutable QMutex m_mutex;
+    QElapsedTimer m_uptime;
+    QHash<QString, qint64> m_counters;
+    QHash<QString, Histogram> m_histograms;
+    QHash<QString, std::function<qint64()>> m_gauges;
+};
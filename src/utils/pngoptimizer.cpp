@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "pngoptimizer.h"
+#include "src/utils/colorquantizer.h"
+#include "src/utils/confighandler.h"
+#include "src/utils/metrics.h"
+#include <QHash>
+
+#define MAX_COLORS 256
+// Beyond this many colors reduced to 5 bits per channel the image is taken
+// for a photo or a gradient, which lose too much to a palette
+#define MAX_REDUCED_COLORS 1024
+
+QImage PngOptimizer::forDestination(const QImage& image,
+                                    Destination destination)
+{
+    ConfigHandler config;
+    bool enabled = false;
+    switch (destination) {
+        case SAVE:
+            enabled = config.optimizePngOnSave();
+            break;
+        case CLIPBOARD:
+            enabled = config.optimizePngOnCopy();
+            break;
+        case UPLOAD:
+            enabled = config.optimizePngOnUpload();
+            break;
+    }
+    return enabled ? optimize(image, config.optimizePngDither()) : image;
+}
+
+QImage PngOptimizer::optimize(const QImage& image, bool dither)
+{
+    if (image.isNull() || image.format() == QImage::Format_Indexed8) {
+        return image;
+    }
+    Metrics::Timer timer(QStringLiteral("optimizePng"));
+    const QImage source = image.convertToFormat(QImage::Format_ARGB32);
+    QImage indexed = exactPalette(source);
+    if (!indexed.isNull()) {
+        return indexed;
+    }
+    if (!isOpaque(source)) {
+        return image;
+    }
+    if (ColorQuantizer::reducedColorCount(source, MAX_REDUCED_COLORS + 1) <=
+        MAX_REDUCED_COLORS) {
+        ColorQuantizer quantizer(
+          ColorQuantizer::medianCut(source, MAX_COLORS));
+        indexed = quantizer.toIndexed(source, dither);
+        if (!indexed.isNull()) {
+            return indexed;
+        }
+    }
+    // The PNG writer only stores an alpha channel for formats that have one
+    return source.convertToFormat(QImage::Format_RGB32);
+}
+
+/**
+ * @brief `image` as a palette image, or a null image when it has more than
+ * MAX_COLORS colors. Transparent colors are kept in the palette.
+ */
+QImage PngOptimizer::exactPalette(const QImage& image)
+{
+    QImage indexed(image.size(), QImage::Format_Indexed8);
+    indexed.setDotsPerMeterX(image.dotsPerMeterX());
+    indexed.setDotsPerMeterY(image.dotsPerMeterY());
+    QHash<QRgb, int> indexes;
+    QVector<QRgb> palette;
+    for (int y = 0; y < image.height(); ++y) {
+        const auto* line = reinterpret_cast<const QRgb*>(image.scanLine(y));
+        uchar* out = indexed.scanLine(y);
+        // Interfaces are made of runs of the same color
+        QRgb previous = 0;
+        int index = -1;
+        for (int x = 0; x < image.width(); ++x) {
+            if (index < 0 || line[x] != previous) {
+                previous = line[x];
+                index = indexes.value(previous, -1);
+                if (index < 0) {
+                    if (palette.size() == MAX_COLORS) {
+                        return QImage();
+                    }
+                    index = palette.size();
+                    indexes.insert(previous, index);
+                    palette.append(previous);
+                }
+            }
+            out[x] = static_cast<uchar>(index);
+        }
+    }
+    indexed.setColorTable(palette);
+    return indexed;
+}
+
+bool PngOptimizer::isOpaque(const QImage& image)
+{
+    if (!image.hasAlphaChannel()) {
+        return true;
+    }
+    for (int y = 0; y < image.height(); ++y) {
+        const auto* line = reinterpret_cast<const QRgb*>(image.scanLine(y));
+        for (int x = 0; x < image.width(); ++x) {
+            if (qAlpha(line[x]) != 255) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
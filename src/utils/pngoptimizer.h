@@ -0,0 +1,33 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QImage>
+
+// Makes captures smaller once written as PNG.
+//
+// Most captures are user interfaces with few colors. An image with at most
+// 256 colors is turned into a palette image as is, and so is written as an
+// 8-bit palette PNG without losing anything. An opaque image with a few more
+// colors, like the shades of anti-aliased text, is quantized to 256 colors
+// by median cut, optionally with dithering. Photos and gradients are kept
+// in true color. The alpha channel of opaque images is dropped either way.
+class PngOptimizer
+{
+public:
+    enum Destination
+    {
+        SAVE,
+        CLIPBOARD,
+        UPLOAD,
+    };
+
+    // `image` optimized when the configuration asks it for `destination`
+    static QImage forDestination(const QImage& image, Destination destination);
+    static QImage optimize(const QImage& image, bool dither);
+
+private:
+    static QImage exactPalette(const QImage& image);
+    static bool isOpaque(const QImage& image);
+};
@@ -5,6 +5,7 @@
 #include "abstractlogger.h"
 #include "src/core/qguiappcurrentscreen.h"
 #include "src/utils/filenamehandler.h"
+#include "src/utils/metrics.h"
 #include "src/utils/systemnotification.h"
 #include <QApplication>
 #include <QDesktopWidget>
@@ -108,6 +109,7 @@ void ScreenGrabber::freeDesktopPortal(bool& ok, QPixmap& res)
 }
 QPixmap ScreenGrabber::grabEntireDesktop(bool& ok)
 {
+    Metrics::Timer timer(QStringLiteral("grab"));
     ok = true;
 #if defined(Q_OS_MACOS)
     QScreen* currentScreen = QGuiAppCurrentScreen().currentScreen();
@@ -214,6 +216,7 @@ QPixmap ScreenGrabber::grabScreen(QScreen* screen, bool& ok)
             return p.copy(geometry);
         }
     } else {
+        Metrics::Timer timer(QStringLiteral("grab"));
         ok = true;
         return screen->grabWindow(QApplication::desktop()->winId(),
                                   geometry.x(),
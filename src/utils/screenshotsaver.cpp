@@ -8,6 +8,9 @@
 #include "src/utils/confighandler.h"
 #include "src/utils/filenamehandler.h"
 #include "src/utils/globalvalues.h"
+#include "src/utils/imagemimedata.h"
+#include "src/utils/metrics.h"
+#include "src/utils/pngoptimizer.h"
 #include "utils/desktopinfo.h"
 
 #if USE_WAYLAND_CLIPBOARD
@@ -29,21 +32,34 @@
 
 bool saveToFilesystem(const QPixmap& capture,
                       const QString& path,
-                      const QString& messagePrefix)
+                      const QString& messagePrefix,
+                      FilenameContext context)
 {
+    if (!context.size.isValid()) {
+        context.size = capture.size();
+    }
     QString completePath = FileNameHandler().properScreenshotPath(
-      path, ConfigHandler().saveAsFileExtension());
+      path, ConfigHandler().saveAsFileExtension(), true, context);
     QFile file{ completePath };
     file.open(QIODevice::WriteOnly);
 
     bool okay;
     QString saveExtension;
     saveExtension = QFileInfo(completePath).suffix().toLower();
-    if (saveExtension == "jpg" || saveExtension == "jpeg") {
-        okay = capture.save(&file, nullptr, ConfigHandler().jpegQuality());
-    } else {
-        okay = capture.save(&file);
+    {
+        Metrics::Timer timer(QStringLiteral("save"));
+        if (saveExtension == "jpg" || saveExtension == "jpeg") {
+            okay = capture.save(&file, nullptr, ConfigHandler().jpegQuality());
+        } else if (saveExtension == "png") {
+            okay = PngOptimizer::forDestination(capture.toImage(),
+                                                PngOptimizer::SAVE)
+                     .save(&file, "PNG");
+        } else {
+            okay = capture.save(&file);
+        }
     }
+    Metrics::instance()->increment(okay ? QStringLiteral("saves")
+                                        : QStringLiteral("saveErrors"));
 
     QString saveMessage = messagePrefix;
     QString notificationPath = completePath;
@@ -60,6 +76,8 @@ bool saveToFilesystem(const QPixmap& capture,
         if (file.error() != QFile::NoError) {
             saveMessage += ": " + file.errorString();
         }
+        // Don't leave the reserved empty file behind
+        file.remove();
         notificationPath = "";
         AbstractLogger::error().attachNotificationPath(notificationPath)
           << saveMessage;
@@ -103,38 +121,38 @@ QString ShowSaveFileDialog(const QString& title, const QString& directory)
 
 void saveToClipboardMime(const QPixmap& capture, const QString& imageType)
 {
-    QByteArray array;
-    QBuffer buffer{ &array };
-    QImageWriter imageWriter{ &buffer, imageType.toUpper().toUtf8() };
-    if (imageType == "jpeg") {
-        imageWriter.setQuality(ConfigHandler().jpegQuality());
-    }
-    imageWriter.write(capture.toImage());
-
-    QPixmap formattedPixmap;
-    bool isLoaded =
-      formattedPixmap.loadFromData(reinterpret_cast<uchar*>(array.data()),
-                                   array.size(),
-                                   imageType.toUpper().toUtf8());
-    if (isLoaded) {
-
-        auto* mimeData = new QMimeData();
-
 #ifdef USE_WAYLAND_CLIPBOARD
-        mimeData->setImageData(formattedPixmap.toImage());
+    // KSystemClipboard copies all the offered data right away, so the image
+    // has to be encoded here
+    if (DesktopInfo().waylandDetected()) {
+        QByteArray array;
+        QBuffer buffer{ &array };
+        QImageWriter imageWriter{ &buffer, imageType.toUpper().toUtf8() };
+        if (imageType == "jpeg") {
+            imageWriter.setQuality(ConfigHandler().jpegQuality());
+        }
+        QImage formattedImage;
+        if (!imageWriter.write(capture.toImage()) ||
+            !formattedImage.loadFromData(array,
+                                         imageType.toUpper().toUtf8())) {
+            AbstractLogger::error()
+              << QObject::tr("Error while saving to clipboard");
+            return;
+        }
+        auto* mimeData = new QMimeData();
+        mimeData->setImageData(formattedImage);
         mimeData->setData(QStringLiteral("x-kde-force-image-copy"),
                           QByteArray());
         KSystemClipboard::instance()->setMimeData(mimeData,
                                                   QClipboard::Clipboard);
-#else
-        mimeData->setData("image/" + imageType, array);
-        QApplication::clipboard()->setMimeData(mimeData);
-#endif
-
-    } else {
-        AbstractLogger::error()
-          << QObject::tr("Error while saving to clipboard");
+        return;
     }
+#endif
+    // The formats are only encoded when they are pasted. JPEG is asked for
+    // by useJpgForClipboard, a lossless format offered along would be
+    // pasted instead.
+    QApplication::clipboard()->setMimeData(
+      new ImageMimeData(capture.toImage(), imageType, imageType == "jpeg"));
 }
 
 // If data is saved to the clipboard before the notification is sent via
@@ -153,20 +171,12 @@ void saveToClipboard(const QPixmap& capture)
         FlameshotDaemon::instance()->showFloatingText(msg);
 #endif
     }
+    // Need to send message before copying to clipboard
     if (ConfigHandler().useJpgForClipboard()) {
         // FIXME - it doesn't work on MacOS
         saveToClipboardMime(capture, "jpeg");
     } else {
-        // Need to send message before copying to clipboard
-#if defined(Q_OS_LINUX) || defined(Q_OS_UNIX)
-        if (DesktopInfo().waylandDetected()) {
-            saveToClipboardMime(capture, "png");
-        } else {
-            QApplication::clipboard()->setPixmap(capture);
-        }
-#else
-        QApplication::clipboard()->setPixmap(capture);
-#endif
+        saveToClipboardMime(capture, "png");
     }
 }
 
@@ -180,8 +190,14 @@ bool saveToFilesystemGUI(const QPixmap& capture)
         defaultSavePath =
           QStandardPaths::writableLocation(QStandardPaths::PicturesLocation);
     }
+    FilenameContext context;
+    context.size = capture.size();
+    // The proposed name is only reserved when no dialog can change it
     QString savePath = FileNameHandler().properScreenshotPath(
-      defaultSavePath, ConfigHandler().saveAsFileExtension());
+      defaultSavePath,
+      ConfigHandler().saveAsFileExtension(),
+      config.savePathFixed(),
+      context);
 #if defined(Q_OS_MACOS)
     for (QWidget* widget : qApp->topLevelWidgets()) {
         QString className(widget->metaObject()->className());
@@ -206,11 +222,20 @@ bool saveToFilesystemGUI(const QPixmap& capture)
 
     QString saveExtension;
     saveExtension = QFileInfo(savePath).suffix().toLower();
-    if (saveExtension == "jpg" || saveExtension == "jpeg") {
-        okay = capture.save(&file, nullptr, ConfigHandler().jpegQuality());
-    } else {
-        okay = capture.save(&file);
+    {
+        Metrics::Timer timer(QStringLiteral("save"));
+        if (saveExtension == "jpg" || saveExtension == "jpeg") {
+            okay = capture.save(&file, nullptr, ConfigHandler().jpegQuality());
+        } else if (saveExtension == "png") {
+            okay = PngOptimizer::forDestination(capture.toImage(),
+                                                PngOptimizer::SAVE)
+                     .save(&file, "PNG");
+        } else {
+            okay = capture.save(&file);
+        }
     }
+    Metrics::instance()->increment(okay ? QStringLiteral("saves")
+                                        : QStringLiteral("saveErrors"));
 
     if (okay) {
         if (!config.savePathFixed()) {
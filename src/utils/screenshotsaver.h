@@ -3,13 +3,15 @@
 
 #pragma once
 
+#include "src/utils/filenameformatter.h"
 #include <QString>
 
 class QPixmap;
 
 bool saveToFilesystem(const QPixmap& capture,
                       const QString& path,
-                      const QString& messagePrefix = "");
+                      const QString& messagePrefix = "",
+                      FilenameContext context = FilenameContext());
 QString ShowSaveFileDialog(const QString& title, const QString& directory);
 void saveToClipboardMime(const QPixmap& capture, const QString& imageType);
 void saveToClipboard(const QPixmap& capture);
@@ -0,0 +1,199 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "scrollstitcher.h"
+#include <QHash>
+#include <QPainter>
+
+// Columns at the right edge left out of the row hashes, the scroll bar thumb
+// moves there
+#define SCROLLBAR_MARGIN 32
+// Rows found this many times in a frame (blank lines, borders) can't tell
+// the offset and don't vote
+#define MAX_ROW_REPEATS 8
+#define MIN_OVERLAP_ROWS 16
+// Share of the overlap that has to match, blinking carets and animations
+// change a few rows
+#define MIN_MATCH_PERCENT 90
+
+ScrollStitcher::ScrollStitcher(int maxHeight)
+  : m_maxHeight(maxHeight)
+  , m_height(0)
+  , m_previousStitched(0)
+{}
+
+ScrollStitcher::FrameResult ScrollStitcher::addFrame(const QImage& frame)
+{
+    if (isFull()) {
+        return FRAME_FULL;
+    }
+    QImage image = frame.convertToFormat(QImage::Format_RGB32);
+    QVector<uint> hashes = rowHashes(image);
+    if (m_previous.isNull()) {
+        m_previous = image;
+        m_previousHashes = hashes;
+        return FRAME_STITCHED;
+    }
+    if (image.size() != m_previous.size()) {
+        return FRAME_NOT_ALIGNED;
+    }
+
+    const int offset = findOffset(m_previousHashes, hashes);
+    if (offset < 0) {
+        return FRAME_NOT_ALIGNED;
+    } else if (offset == 0) {
+        return FRAME_UNCHANGED;
+    }
+
+    // A footer stays at the bottom of every frame, it is added once by
+    // result()
+    const int contentEnd =
+      image.height() - staticBottomRows(m_previousHashes, hashes);
+    append(m_previous, m_previousStitched, contentEnd);
+    append(image, qMax(0, contentEnd - offset), contentEnd);
+
+    m_previous = image;
+    m_previousHashes = hashes;
+    m_previousStitched = contentEnd;
+    return isFull() ? FRAME_FULL : FRAME_STITCHED;
+}
+
+int ScrollStitcher::height() const
+{
+    if (m_previous.isNull()) {
+        return m_height;
+    }
+    return qMin(m_maxHeight,
+                m_height + m_previous.height() - m_previousStitched);
+}
+
+bool ScrollStitcher::isFull() const
+{
+    return m_height >= m_maxHeight;
+}
+
+QImage ScrollStitcher::result() const
+{
+    if (m_previous.isNull()) {
+        return QImage();
+    }
+    QImage res(m_previous.width(), height(), QImage::Format_RGB32);
+    QPainter painter(&res);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    int y = 0;
+    for (const QImage& strip : m_strips) {
+        painter.drawImage(0, y, strip);
+        y += strip.height();
+    }
+    // The rest of the last frame, its footer included
+    painter.drawImage(QPoint(0, y),
+                      m_previous,
+                      QRect(0,
+                            m_previousStitched,
+                            m_previous.width(),
+                            m_previous.height() - m_previousStitched));
+    painter.end();
+    res.setDevicePixelRatio(m_previous.devicePixelRatio());
+    return res;
+}
+
+QVector<uint> ScrollStitcher::rowHashes(const QImage& image)
+{
+    Q_ASSERT(image.depth() == 32);
+    int columns = image.width();
+    if (columns > 4 * SCROLLBAR_MARGIN) {
+        columns -= SCROLLBAR_MARGIN;
+    }
+    QVector<uint> hashes(image.height());
+    for (int y = 0; y < image.height(); ++y) {
+        hashes[y] = static_cast<uint>(
+          qHashBits(image.constScanLine(y), columns * sizeof(QRgb)));
+    }
+    return hashes;
+}
+
+int ScrollStitcher::findOffset(const QVector<uint>& previous,
+                               const QVector<uint>& current)
+{
+    const int rows = current.size();
+    if (previous.size() != rows || rows == 0) {
+        return -1;
+    }
+    // Rows at the same place in both frames did not scroll
+    QVector<bool> moving(rows);
+    bool scrolled = false;
+    for (int y = 0; y < rows; ++y) {
+        moving[y] = previous[y] != current[y];
+        scrolled |= moving[y];
+    }
+    if (!scrolled) {
+        return 0;
+    }
+
+    QHash<uint, QVector<int>> positions;
+    for (int y = 0; y < rows; ++y) {
+        if (moving[y]) {
+            positions[previous[y]].append(y);
+        }
+    }
+    QVector<int> votes(rows, 0);
+    for (int y = 0; y < rows; ++y) {
+        if (!moving[y]) {
+            continue;
+        }
+        auto found = positions.constFind(current[y]);
+        if (found == positions.cend() || found->size() > MAX_ROW_REPEATS) {
+            continue;
+        }
+        for (int position : *found) {
+            if (position > y) {
+                ++votes[position - y];
+            }
+        }
+    }
+    // Ties go to the smallest offset
+    int best = 0;
+    for (int offset = 1; offset < rows; ++offset) {
+        if (votes[offset] > votes[best]) {
+            best = offset;
+        }
+    }
+    if (best == 0) {
+        return -1;
+    }
+
+    int overlap = 0, matching = 0;
+    for (int y = 0; y + best < rows; ++y) {
+        // Rows moved onto a sticky footer are no part of the overlap
+        if (moving[y] && moving[y + best]) {
+            ++overlap;
+            matching += current[y] == previous[y + best] ? 1 : 0;
+        }
+    }
+    if (overlap < MIN_OVERLAP_ROWS ||
+        matching * 100 < overlap * MIN_MATCH_PERCENT) {
+        return -1;
+    }
+    return best;
+}
+
+int ScrollStitcher::staticBottomRows(const QVector<uint>& previous,
+                                     const QVector<uint>& current)
+{
+    int rows = 0;
+    for (int y = current.size() - 1; y >= 0 && previous[y] == current[y];
+         --y) {
+        ++rows;
+    }
+    return rows;
+}
+
+void ScrollStitcher::append(const QImage& frame, int from, int to)
+{
+    to = qMin(to, from + m_maxHeight - m_height);
+    if (to <= from) {
+        return;
+    }
+    m_strips << frame.copy(0, from, frame.width(), to - from);
+    m_height += to - from;
+}
@@ -0,0 +1,63 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QImage>
+#include <QVector>
+
+// Stitches the frames of a region grabbed while its content scrolls down into
+// one tall image.
+//
+// Consecutive frames are aligned from hashes of their rows. The rows found at
+// the same place in both frames did not scroll (sticky headers and footers)
+// and are left out, the other rows vote for the offset at which the previous
+// frame has the same row, and the most voted offset is checked over the whole
+// overlap. Only the rows scrolled in are kept, along with the last frame, so
+// the memory used follows the height of the result and not the number of
+// frames.
+class ScrollStitcher
+{
+public:
+    enum FrameResult
+    {
+        FRAME_STITCHED,
+        // Nothing scrolled since the previous frame
+        FRAME_UNCHANGED,
+        // No offset fits, the content scrolled up or too far between frames
+        FRAME_NOT_ALIGNED,
+        // The result reached the maximum height
+        FRAME_FULL,
+    };
+
+    explicit ScrollStitcher(int maxHeight = 32000);
+
+    FrameResult addFrame(const QImage& frame);
+    // Height of the result so far
+    int height() const;
+    bool isFull() const;
+    QImage result() const;
+
+    // Hashes of the rows of `image`, without the right edge where the scroll
+    // bars move
+    static QVector<uint> rowHashes(const QImage& image);
+    // Offset of the frame with the `current` row hashes below the one with
+    // the `previous` hashes: row y of the current frame shows row y + offset
+    // of the previous one. Returns 0 when nothing scrolled and -1 when no
+    // offset fits.
+    static int findOffset(const QVector<uint>& previous,
+                          const QVector<uint>& current);
+
+private:
+    static int staticBottomRows(const QVector<uint>& previous,
+                                const QVector<uint>& current);
+    void append(const QImage& frame, int from, int to);
+
+    int m_maxHeight;
+    int m_height;
+    QVector<QImage> m_strips;
+    QImage m_previous;
+    QVector<uint> m_previousHashes;
+    // Rows of the previous frame already in the strips
+    int m_previousStitched;
+};
@@ -2,12 +2,17 @@
 #include "src/core/flameshot.h"
 #include "src/utils/confighandler.h"
 #include <QApplication>
+#include <QThread>
 #include <QUrl>
 
 #if !(defined(Q_OS_MACOS) || defined(Q_OS_WIN))
+#include <QCache>
 #include <QDBusConnection>
-#include <QDBusInterface>
 #include <QDBusMessage>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
+#include <QHash>
+#include <QSet>
 #else
 #include "src/core/flameshotdaemon.h"
 #endif
@@ -19,19 +24,127 @@
 #define FLAMESHOT_ICON "flameshot"
 #endif
 
-SystemNotification::SystemNotification(QObject* parent)
-  : QObject(parent)
-  , m_interface(nullptr)
-{
 #if !(defined(Q_OS_MACOS) || defined(Q_OS_WIN))
-    m_interface =
-      new QDBusInterface(QStringLiteral("org.freedesktop.Notifications"),
-                         QStringLiteral("/org/freedesktop/Notifications"),
-                         QStringLiteral("org.freedesktop.Notifications"),
-                         QDBusConnection::sessionBus(),
-                         this);
-#endif
+namespace {
+// Longest time a notification server may take to answer, a hung server
+// must not keep the following notifications waiting forever
+constexpr int NOTIFY_CALL_TIMEOUT = 2000;
+// Ids kept for replacing the notifications, the least recently shown ones
+// are forgotten first
+constexpr int MAX_NOTIFICATION_IDS = 64;
+
+struct Notification
+{
+    QString text;
+    QString title;
+    QString savePath;
+    int timeout;
+};
+
+// Client of org.freedesktop.Notifications shared by the whole application.
+//
+// The calls are asynchronous and built without introspecting the server.
+// A notification with the same title and text as a previous one replaces it
+// through the replaces_id argument of Notify, and while a call is waiting
+// for its reply only the latest of those is kept to be sent next. The calls
+// still waiting for their reply when the application quits are waited for,
+// so a CLI process exiting right after its notification still shows it.
+class NotificationClient : public QObject
+{
+public:
+    static NotificationClient* instance()
+    {
+        static auto* client = new NotificationClient(qApp);
+        return client;
+    }
+
+    // bounded by NOTIFY_CALL_TIMEOUT for each call
+    void flush()
+    {
+        for (auto* watcher : findChildren<QDBusPendingCallWatcher*>()) {
+            watcher->waitForFinished();
+        }
+    }
+
+    void send(const Notification& notification)
+    {
+        const QString key = notification.title + '\n' + notification.text;
+        if (m_inFlight.contains(key)) {
+            m_pending.insert(key, notification);
+            return;
+        }
+        m_inFlight.insert(key);
+
+        QVariantMap hintsMap;
+        if (!notification.savePath.isEmpty()) {
+            QUrl fullPath = QUrl::fromLocalFile(notification.savePath);
+            // allows the notification to be dragged and dropped
+            hintsMap[QStringLiteral("x-kde-urls")] =
+              QStringList({ fullPath.toString() });
+        }
+
+        QDBusMessage m = QDBusMessage::createMethodCall(
+          QStringLiteral("org.freedesktop.Notifications"),
+          QStringLiteral("/org/freedesktop/Notifications"),
+          QStringLiteral("org.freedesktop.Notifications"),
+          QStringLiteral("Notify"));
+        m << (qAppName())                 // appname
+          << replacedId(key)              // id
+          << FLAMESHOT_ICON               // icon
+          << notification.title           // summary
+          << notification.text            // body
+          << QStringList()                // actions
+          << hintsMap                     // hints
+          << notification.timeout;        // timeout
+        QDBusPendingCall call =
+          QDBusConnection::sessionBus().asyncCall(m, NOTIFY_CALL_TIMEOUT);
+
+        auto* watcher = new QDBusPendingCallWatcher(call, this);
+        connect(watcher,
+                &QDBusPendingCallWatcher::finished,
+                this,
+                [this, key](QDBusPendingCallWatcher* watcher) {
+                    QDBusPendingReply<uint> reply = *watcher;
+                    if (reply.isError()) {
+                        m_ids.remove(key);
+                    } else {
+                        m_ids.insert(key, new uint(reply.value()));
+                    }
+                    watcher->deleteLater();
+                    m_inFlight.remove(key);
+                    if (m_pending.contains(key)) {
+                        send(m_pending.take(key));
+                    }
+                });
+    }
+
+private:
+    explicit NotificationClient(QObject* parent)
+      : QObject(parent)
+      , m_ids(MAX_NOTIFICATION_IDS)
+    {
+        connect(qApp, &QCoreApplication::aboutToQuit, this, [this]() {
+            flush();
+        });
+    }
+
+    uint replacedId(const QString& key)
+    {
+        const uint* id = m_ids.object(key);
+        return id != nullptr ? *id : 0;
+    }
+
+    // Id of the last notification shown for each title and text
+    QCache<QString, uint> m_ids;
+    QSet<QString> m_inFlight;
+    QHash<QString, Notification> m_pending;
+};
 }
+#endif
+
+SystemNotification::SystemNotification(QObject* parent)
+  : QObject(parent)
+{}
 
 void SystemNotification::sendMessage(const QString& text,
                                      const QString& savePath)
@@ -50,8 +163,8 @@ void SystemNotification::sendMessage(const QString& text,
 
 #if defined(Q_OS_MACOS) || defined(Q_OS_WIN)
     QMetaObject::invokeMethod(
-      this,
-      [&]() {
+      qApp,
+      [=]() {
           // The call is queued to avoid recursive static initialization of
           // Flameshot and ConfigHandler.
           if (FlameshotDaemon::instance())
@@ -60,24 +173,14 @@ void SystemNotification::sendMessage(const QString& text,
       },
       Qt::QueuedConnection);
 #else
-    QList<QVariant> args;
-    QVariantMap hintsMap;
-    if (!savePath.isEmpty()) {
-        QUrl fullPath = QUrl::fromLocalFile(savePath);
-        // allows the notification to be dragged and dropped
-        hintsMap[QStringLiteral("x-kde-urls")] =
-          QStringList({ fullPath.toString() });
+    Notification notification{ text, title, savePath, timeout };
+    if (QThread::currentThread() == qApp->thread()) {
+        NotificationClient::instance()->send(notification);
+    } else {
+        QMetaObject::invokeMethod(
+          qApp,
+          [=]() { NotificationClient::instance()->send(notification); },
+          Qt::QueuedConnection);
     }
-
-    args << (qAppName())                 // appname
-         << static_cast<unsigned int>(0) // id
-         << FLAMESHOT_ICON               // icon
-         << title                        // summary
-         << text                         // body
-         << QStringList()                // actions
-         << hintsMap                     // hints
-         << timeout;                     // timeout
-    m_interface->callWithArgumentList(
-      QDBus::AutoDetect, QStringLiteral("Notify"), args);
 #endif
 }
@@ -5,8 +5,6 @@
 
 #include <QObject>
 
-class QDBusInterface;
-
 class SystemNotification : public QObject
 {
     Q_OBJECT
@@ -19,7 +17,4 @@ public:
                      const QString& title,
                      const QString& savePath,
                      const int timeout = 5000);
-
-private:
-    QDBusInterface* m_interface;
 };
@@ -0,0 +1,103 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "trigramindex.h"
+#include <QRegExp>
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+
+void TrigramIndex::clear()
+{
+    m_documents.clear();
+    m_trigrams.clear();
+}
+
+void TrigramIndex::add(const QStringList& fields)
+{
+    const int document = m_documents.size();
+    m_documents << fields;
+    for (const QString& field : fields) {
+        QString text = field.toLower();
+        for (int i = 0; i + 3 <= text.size(); ++i) {
+            QVector<int>& documents = m_trigrams[text.mid(i, 3)];
+            if (documents.isEmpty() || documents.last() != document) {
+                documents << document;
+            }
+        }
+    }
+}
+
+int TrigramIndex::size() const
+{
+    return m_documents.size();
+}
+
+QVector<int> TrigramIndex::search(const QString& pattern) const
+{
+    QRegExp regexp(pattern, Qt::CaseInsensitive, QRegExp::Wildcard);
+    QVector<int> res;
+    for (int document : candidates(pattern)) {
+        for (const QString& field : m_documents[document]) {
+            if (field.contains(regexp)) {
+                res << document;
+                break;
+            }
+        }
+    }
+    return res;
+}
+
+QVector<int> TrigramIndex::candidates(const QString& pattern) const
+{
+    // Split the pattern into its literal parts, the wildcards and the
+    // character sets don't restrict the candidates
+    QStringList literals;
+    QString literal;
+    bool inSet = false;
+    for (const QChar& c : pattern.toLower()) {
+        if (inSet) {
+            inSet = c != QLatin1Char(']');
+        } else if (c == QLatin1Char('*') || c == QLatin1Char('?') ||
+                   c == QLatin1Char('[')) {
+            inSet = c == QLatin1Char('[');
+            literals << literal;
+            literal.clear();
+        } else {
+            literal += c;
+        }
+    }
+    literals << literal;
+
+    QVector<int> res;
+    bool restricted = false;
+    for (const QString& part : qAsConst(literals)) {
+        for (int i = 0; i + 3 <= part.size(); ++i) {
+            auto it = m_trigrams.constFind(part.mid(i, 3));
+            if (it == m_trigrams.constEnd()) {
+                return {};
+            }
+            if (!restricted) {
+                res = it.value();
+                restricted = true;
+                continue;
+            }
+            QVector<int> intersection;
+            std::set_intersection(res.constBegin(),
+                                  res.constEnd(),
+                                  it.value().constBegin(),
+                                  it.value().constEnd(),
+                                  std::back_inserter(intersection));
+            res = intersection;
+            if (res.isEmpty()) {
+                return res;
+            }
+        }
+    }
+    if (!restricted) {
+        // Too short to use the trigrams
+        res.resize(m_documents.size());
+        std::iota(res.begin(), res.end(), 0);
+    }
+    return res;
+}
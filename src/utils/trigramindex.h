@@ -0,0 +1,33 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+
+// Case insensitive search of wildcard expressions in a list of documents made
+// of several text fields.
+//
+// Every trigram of the documents is mapped to the sorted list of documents
+// containing it. A search only tests the expression against the documents
+// containing all the trigrams of its literal parts instead of all of them.
+class TrigramIndex
+{
+public:
+    void clear();
+    // Add a document, its index is the number of documents added before it
+    void add(const QStringList& fields);
+    int size() const;
+
+    // Sorted indexes of the documents with a field matching the wildcard
+    // expression `pattern`, like QRegExp::Wildcard with QString::contains()
+    QVector<int> search(const QString& pattern) const;
+
+private:
+    QVector<int> candidates(const QString& pattern) const;
+
+    QVector<QStringList> m_documents;
+    QHash<QString, QVector<int>> m_trigrams;
+};
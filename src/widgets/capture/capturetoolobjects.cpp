@@ -14,8 +14,11 @@ CaptureToolObjects::CaptureToolObjects(QObject* parent)
 void CaptureToolObjects::append(const QPointer<CaptureTool>& captureTool)
 {
     if (!captureTool.isNull()) {
+        const int index = m_captureToolObjects.size();
+        emit objectsAboutToBeInserted(index, index);
         m_captureToolObjects.append(captureTool->copy(captureTool->parent()));
         m_imageCache.clear();
+        emit objectsInserted();
     }
 }
 
@@ -24,13 +27,15 @@ void CaptureToolObjects::insert(int index,
 {
     if (!captureTool.isNull() && index >= 0 &&
         index <= m_captureToolObjects.size()) {
+        emit objectsAboutToBeInserted(index, index);
         m_captureToolObjects.insert(index,
                                     captureTool->copy(captureTool->parent()));
         m_imageCache.clear();
+        emit objectsInserted();
     }
 }
 
-QPointer<CaptureTool> CaptureToolObjects::at(int index)
+QPointer<CaptureTool> CaptureToolObjects::at(int index) const
 {
     if (index >= 0 && index < m_captureToolObjects.size()) {
         return m_captureToolObjects[index];
@@ -40,15 +45,28 @@ QPointer<CaptureTool> CaptureToolObjects::at(int index)
 
 void CaptureToolObjects::clear()
 {
+    if (m_captureToolObjects.isEmpty()) {
+        return;
+    }
+    emit objectsAboutToBeRemoved(0, m_captureToolObjects.size() - 1);
     m_captureToolObjects.clear();
+    emit objectsRemoved();
 }
 
-QList<QPointer<CaptureTool>> CaptureToolObjects::captureToolObjects()
+void CaptureToolObjects::markChanged(int index)
+{
+    if (index >= 0 && index < m_captureToolObjects.size()) {
+        emit objectsChanged(index, index);
+    }
+}
+
+const QList<QPointer<CaptureTool>>& CaptureToolObjects::captureToolObjects()
+  const
 {
     return m_captureToolObjects;
 }
 
-int CaptureToolObjects::size()
+int CaptureToolObjects::size() const
 {
     return m_captureToolObjects.size();
 }
@@ -56,11 +74,27 @@ int CaptureToolObjects::size()
 void CaptureToolObjects::removeAt(int index)
 {
     if (index >= 0 && index < m_captureToolObjects.size()) {
+        emit objectsAboutToBeRemoved(index, index);
         m_captureToolObjects.removeAt(index);
         m_imageCache.clear();
+        emit objectsRemoved();
     }
 }
 
+// Moves the object itself, unlike a removeAt() and insert() pair which
+// inserts a copy
+void CaptureToolObjects::move(int from, int to)
+{
+    const int size = m_captureToolObjects.size();
+    if (from == to || from < 0 || from >= size || to < 0 || to >= size) {
+        return;
+    }
+    emit objectAboutToBeMoved(from, to);
+    m_captureToolObjects.move(from, to);
+    m_imageCache.clear();
+    emit objectMoved();
+}
+
 int CaptureToolObjects::find(const QPoint& pos, QSize captureSize)
 {
     if (m_captureToolObjects.empty()) {
@@ -142,21 +176,34 @@ int CaptureToolObjects::findWithRadius(QPainter& painter,
 CaptureToolObjects& CaptureToolObjects::operator=(
   const CaptureToolObjects& other)
 {
+    const int size = this->m_captureToolObjects.size();
+    const int otherSize = other.m_captureToolObjects.size();
     // remove extra items for this if size is bigger
-    while (this->m_captureToolObjects.size() >
-           other.m_captureToolObjects.size()) {
-        this->m_captureToolObjects.removeLast();
+    if (size > otherSize) {
+        emit objectsAboutToBeRemoved(otherSize, size - 1);
+        while (this->m_captureToolObjects.size() > otherSize) {
+            this->m_captureToolObjects.removeLast();
+        }
+        emit objectsRemoved();
     }
 
-    int count = 0;
-    for (const auto& item : other.m_captureToolObjects) {
-        QPointer<CaptureTool> itemCopy = item->copy(item->parent());
-        if (count < this->m_captureToolObjects.size()) {
-            this->m_captureToolObjects[count] = itemCopy;
-        } else {
-            this->m_captureToolObjects.append(itemCopy);
+    const int kept = qMin(size, otherSize);
+    for (int i = 0; i < kept; ++i) {
+        const auto& item = other.m_captureToolObjects.at(i);
+        this->m_captureToolObjects[i] = item->copy(item->parent());
+    }
+    if (kept > 0) {
+        emit objectsChanged(0, kept - 1);
+    }
+
+    if (otherSize > size) {
+        emit objectsAboutToBeInserted(size, otherSize - 1);
+        for (int i = size; i < otherSize; ++i) {
+            const auto& item = other.m_captureToolObjects.at(i);
+            this->m_captureToolObjects.append(item->copy(item->parent()));
         }
-        count++;
+        emit objectsInserted();
     }
+    m_imageCache.clear();
     return *this;
 }
@@ -8,20 +8,36 @@
 #include <QList>
 #include <QPointer>
 
+// Annotations of the capture, bottom to top. Every change is announced with
+// the signals below, which mirror the ones of QAbstractItemModel so the
+// layers list can follow the objects row by row.
 class CaptureToolObjects : public QObject
 {
+    Q_OBJECT
 public:
     explicit CaptureToolObjects(QObject* parent = nullptr);
-    QList<QPointer<CaptureTool>> captureToolObjects();
+    const QList<QPointer<CaptureTool>>& captureToolObjects() const;
     void append(const QPointer<CaptureTool>& captureTool);
     void insert(int index, const QPointer<CaptureTool>& captureTool);
     void removeAt(int index);
+    void move(int from, int to);
     void clear();
-    int size();
+    // The object at `index` was modified in place
+    void markChanged(int index);
+    int size() const;
     int find(const QPoint& pos, QSize captureSize);
-    QPointer<CaptureTool> at(int index);
+    QPointer<CaptureTool> at(int index) const;
     CaptureToolObjects& operator=(const CaptureToolObjects& other);
 
+signals:
+    void objectsAboutToBeInserted(int first, int last);
+    void objectsInserted();
+    void objectsAboutToBeRemoved(int first, int last);
+    void objectsRemoved();
+    void objectAboutToBeMoved(int from, int to);
+    void objectMoved();
+    void objectsChanged(int first, int last);
+
 private:
     int findWithRadius(QPainter& painter,
                        QPixmap& pixmap,
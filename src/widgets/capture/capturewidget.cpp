@@ -24,6 +24,7 @@
 #include "src/utils/screenshotsaver.h"
 #include "src/utils/systemnotification.h"
 #include "src/widgets/capture/colorpicker.h"
+#include "src/widgets/capture/exportrenderer.h"
 #include "src/widgets/capture/hovereventfilter.h"
 #include "src/widgets/capture/modificationcommand.h"
 #include "src/widgets/capture/notifierbox.h"
@@ -119,7 +120,7 @@ CaptureWidget::CaptureWidget(const CaptureRequest& req,
             AbstractLogger::error() << tr("Unable to capture screen");
             this->close();
         }
-        m_context.origScreenshot = m_context.screenshot;
+        m_context.origTiles.reset(m_context.screenshot);
 
 #if defined(Q_OS_WIN)
 // Call cmake with -DFLAMESHOT_DEBUG_CAPTURE=ON to enable easier debugging
@@ -284,7 +285,10 @@ CaptureWidget::~CaptureWidget()
         QRect geometry(m_context.selection);
         geometry.moveTo(geometry.topLeft() + m_context.widgetOffset);
         Flameshot::instance()->exportCapture(
-          pixmap(), geometry, m_context.request);
+          pixmap(),
+          geometry,
+          m_context.request,
+          lastRegion.normalized().translated(m_context.widgetOffset));
     } else {
         emit Flameshot::instance()->captureFailed();
     }
@@ -545,6 +549,19 @@ void CaptureWidget::initHelpMessage()
 
 QPixmap CaptureWidget::pixmap()
 {
+    if (m_captureToolObjects.size() > 0) {
+        // Render the objects again in parallel, this also leaves out the
+        // object selection drawn on the screenshot
+        ExportRenderer renderer(m_context.screenshot,
+                                m_context.origTiles,
+                                m_captureToolObjects.captureToolObjects());
+        QPixmap rendered = renderer.render(m_context.selection);
+        if (!rendered.isNull()) {
+            return rendered;
+        }
+        // take the replayed screenshot, without the object selection
+        drawToolsData(false);
+    }
     return m_context.selectedScreenshotArea();
 }
 
@@ -1308,7 +1325,7 @@ void CaptureWidget::initPanel()
     m_panel->pushWidget(m_sidePanel);
 
     // Fill undo/redo/history list widget
-    m_panel->fillCaptureTools(m_captureToolObjects.captureToolObjects());
+    m_panel->setCaptureToolObjects(&m_captureToolObjects);
 }
 
 #if !defined(DISABLE_UPDATE_CHECKER)
@@ -1597,20 +1614,14 @@ void CaptureWidget::onMoveCaptureToolUp(int captureToolIndex)
 {
     m_captureToolObjectsBackup = m_captureToolObjects;
     pushObjectsStateToUndoStack();
-    auto tool = m_captureToolObjects.at(captureToolIndex);
-    m_captureToolObjects.removeAt(captureToolIndex);
-    m_captureToolObjects.insert(captureToolIndex - 1, tool);
-    updateLayersPanel();
+    m_captureToolObjects.move(captureToolIndex, captureToolIndex - 1);
 }
 
 void CaptureWidget::onMoveCaptureToolDown(int captureToolIndex)
 {
     m_captureToolObjectsBackup = m_captureToolObjects;
     pushObjectsStateToUndoStack();
-    auto tool = m_captureToolObjects.at(captureToolIndex);
-    m_captureToolObjects.removeAt(captureToolIndex);
-    m_captureToolObjects.insert(captureToolIndex + 1, tool);
-    updateLayersPanel();
+    m_captureToolObjects.move(captureToolIndex, captureToolIndex + 1);
 }
 
 void CaptureWidget::selectAll()
@@ -1644,13 +1655,13 @@ void CaptureWidget::removeToolObject(int index)
                 auto circleTool = m_captureToolObjects.at(cnt);
                 if (circleTool->count() >= removedCircleCount) {
                     circleTool->setCount(circleTool->count() - 1);
+                    m_captureToolObjects.markChanged(cnt);
                 }
             }
         }
         m_captureToolObjects.removeAt(index);
         pushObjectsStateToUndoStack();
         drawToolsData();
-        updateLayersPanel();
     }
 }
 
@@ -1829,9 +1840,11 @@ void CaptureWidget::updateTool(CaptureTool* tool)
     oldToolObjectRect = toolObjectRect;
 }
 
+// The layers panel follows the objects added, removed and moved on its own,
+// only an object modified in place has to be refreshed
 void CaptureWidget::updateLayersPanel()
 {
-    m_panel->fillCaptureTools(m_captureToolObjects.captureToolObjects());
+    m_captureToolObjects.markChanged(m_panel->activeLayerIndex());
 }
 
 void CaptureWidget::pushToolToStack()
@@ -1859,7 +1872,6 @@ void CaptureWidget::pushToolToStack()
         pushObjectsStateToUndoStack();
         releaseActiveTool();
         drawToolsData();
-        updateLayersPanel();
 
         // restore signal connection for updating layer
         m_panel->blockSignals(false);
@@ -1868,15 +1880,19 @@ void CaptureWidget::pushToolToStack()
 
 void CaptureWidget::drawToolsData(bool drawSelection)
 {
-    // TODO refactor this for performance. The objects should not all be updated
-    // at once every time
-    QPixmap pixmapItem = m_context.origScreenshot;
-    for (auto toolItem : m_captureToolObjects.captureToolObjects()) {
-        processPixmapWithTool(&pixmapItem, toolItem);
-        update(paddedUpdateRect(toolItem->boundingRect()));
+    update(ExportRenderer::replay(m_context.screenshot,
+                                  m_context.origTiles,
+                                  m_captureToolObjects.captureToolObjects()));
+#ifdef QT_DEBUG
+    static int savedTiles = 0;
+    if (savedTiles != m_context.origTiles.savedTileCount()) {
+        savedTiles = m_context.origTiles.savedTileCount();
+        qDebug() << "Screenshot tiles saved:" << savedTiles << "of"
+                 << m_context.origTiles.tileCount() << "-"
+                 << m_context.origTiles.memoryUsage() / 1024 << "KiB";
     }
+#endif
 
-    m_context.screenshot = pixmapItem;
     if (drawSelection) {
         drawObjectSelection();
     }
@@ -1886,6 +1902,8 @@ void CaptureWidget::drawObjectSelection()
 {
     auto toolItem = activeToolObject();
     if (toolItem && !toolItem->editMode()) {
+        m_context.origTiles.preserve(
+          m_context.screenshot, paddedUpdateRect(toolItem->boundingRect()));
         QPainter painter(&m_context.screenshot);
         toolItem->drawObjectSelection(painter);
         // TODO move this elsewhere
@@ -1900,6 +1918,10 @@ void CaptureWidget::drawObjectSelection()
 
 void CaptureWidget::processPixmapWithTool(QPixmap* pixmap, CaptureTool* tool)
 {
+    if (pixmap == &m_context.screenshot) {
+        ExportRenderer::paint(m_context.screenshot, m_context.origTiles, tool);
+        return;
+    }
     QPainter painter(pixmap);
     painter.setRenderHint(QPainter::Antialiasing);
     tool->process(painter, *pixmap);
@@ -2005,7 +2027,6 @@ void CaptureWidget::setCaptureToolObjects(
     // Used for undo/redo
     m_captureToolObjects = captureToolObjects;
     drawToolsData();
-    updateLayersPanel();
     drawObjectSelection();
 }
 
@@ -2023,7 +2044,6 @@ void CaptureWidget::undo()
     drawToolsData();
     m_undoStack.undo();
     drawToolsData();
-    updateLayersPanel();
 
     restoreCircleCountState();
 }
@@ -2036,7 +2056,6 @@ void CaptureWidget::redo()
     m_undoStack.redo();
     drawToolsData();
     update();
-    updateLayersPanel();
 
     restoreCircleCountState();
 }
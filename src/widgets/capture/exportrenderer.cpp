@@ -0,0 +1,263 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "exportrenderer.h"
+#include <QHash>
+#include <QPainter>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThreadPool>
+#include <QVector>
+#include <cmath>
+#include <functional>
+
+namespace {
+int findRoot(QVector<int>& parents, int index)
+{
+    while (parents[index] != index) {
+        parents[index] = parents[parents[index]];
+        index = parents[index];
+    }
+    return index;
+}
+}
+
+class ClusterTask : public QRunnable
+{
+public:
+    explicit ClusterTask(std::function<void()> job)
+      : m_job(std::move(job))
+    {}
+    void run() override { m_job(); }
+
+private:
+    std::function<void()> m_job;
+};
+
+ExportRenderer::ExportRenderer(const QPixmap& screenshot,
+                               const ImageTileStore& origTiles,
+                               const QList<QPointer<CaptureTool>>& objects)
+  : m_screenshot(screenshot)
+  , m_origTiles(origTiles)
+  , m_objects(objects)
+  , m_devicePixelRatio(screenshot.devicePixelRatio())
+{}
+
+QPixmap ExportRenderer::render(const QRect& selection) const
+{
+    if (m_screenshot.isNull()) {
+        return {};
+    }
+    QRect area(QPoint(0, 0), m_screenshot.size());
+    if (!selection.isNull()) {
+        area = area.intersected(selection);
+    }
+    int step = alignmentStep();
+    if (step == 0) {
+        return {};
+    }
+    QRect screen(0,
+                 0,
+                 static_cast<int>(m_screenshot.width() / m_devicePixelRatio),
+                 static_cast<int>(m_screenshot.height() / m_devicePixelRatio));
+    QRect logicalArea = QRectF(area.x() / m_devicePixelRatio,
+                               area.y() / m_devicePixelRatio,
+                               area.width() / m_devicePixelRatio,
+                               area.height() / m_devicePixelRatio)
+                          .toAlignedRect();
+
+    for (const auto& object : m_objects) {
+        // The tile of a cluster can't hold an object painting anywhere, and
+        // tools reading the screenshot are clipped differently when they go
+        // past the screen
+        if (!object.isNull() && !object->boundingRect().isNull() &&
+            (object->paintedRect().isNull() ||
+             (readsPixmap(object) &&
+              !screen.contains(object->boundingRect())))) {
+            return {};
+        }
+    }
+
+    QVector<Cluster> parts = clusters(logicalArea);
+    for (Cluster& cluster : parts) {
+        // The tile has to start on a whole device pixel so the objects are
+        // rasterized exactly like on the full screenshot
+        QRect bounds = cluster.region.boundingRect().intersected(screen);
+        bounds.setLeft(bounds.left() - bounds.left() % step);
+        bounds.setTop(bounds.top() - bounds.top() % step);
+        cluster.bounds = bounds;
+        cluster.canvas =
+          m_origTiles.original(m_screenshot, toDeviceRect(cluster.bounds));
+    }
+
+    // The current thread renders the first cluster while the pool takes
+    // care of the others
+    QSemaphore done;
+    for (int i = 1; i < parts.size(); ++i) {
+        Cluster* cluster = &parts[i];
+        QThreadPool::globalInstance()->start(
+          new ClusterTask([cluster, &done]() {
+              renderCluster(*cluster);
+              done.release();
+          }));
+    }
+    if (!parts.isEmpty()) {
+        renderCluster(parts[0]);
+        done.acquire(parts.size() - 1);
+    }
+
+    QPixmap result = m_origTiles.original(m_screenshot, area);
+    // composite in device pixels, without any scaling
+    result.setDevicePixelRatio(1);
+    QPainter painter(&result);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    painter.translate(-area.topLeft());
+    for (Cluster& cluster : parts) {
+        QRegion deviceRegion;
+        for (const QRect& r : cluster.region) {
+            deviceRegion += toDeviceRect(r);
+        }
+        painter.setClipRegion(deviceRegion);
+        cluster.canvas.setDevicePixelRatio(1);
+        painter.drawPixmap(toDeviceRect(cluster.bounds).topLeft(),
+                           cluster.canvas);
+    }
+    painter.end();
+    result.setDevicePixelRatio(m_devicePixelRatio);
+    return result;
+}
+
+QRect ExportRenderer::paintedRect(const CaptureTool* tool,
+                                  const QPixmap& screenshot)
+{
+    if (tool->boundingRect().isNull()) {
+        return {};
+    }
+    QRect screen(QPoint(0, 0),
+                 screenshot.size() / screenshot.devicePixelRatio());
+    QRect painted = tool->paintedRect();
+    if (painted.isNull()) {
+        return screen;
+    }
+    return painted.intersected(screen);
+}
+
+QRect ExportRenderer::paint(QPixmap& screenshot,
+                            ImageTileStore& origTiles,
+                            CaptureTool* tool)
+{
+    QRect painted = paintedRect(tool, screenshot);
+    // keep the original content of the tiles about to be painted over
+    origTiles.preserve(screenshot, painted);
+    QPainter painter(&screenshot);
+    painter.setRenderHint(QPainter::Antialiasing);
+    tool->process(painter, screenshot);
+    return painted;
+}
+
+QRegion ExportRenderer::replay(QPixmap& screenshot,
+                               ImageTileStore& origTiles,
+                               const QList<QPointer<CaptureTool>>& objects)
+{
+    // Revert only the tiles painted over so far instead of copying the whole
+    // original screenshot, then replay the objects on top of them
+    QRegion changed = origTiles.modifiedRegion();
+    {
+        QPainter painter(&screenshot);
+        origTiles.restore(painter);
+    }
+    for (const auto& object : objects) {
+        if (!object.isNull()) {
+            changed += paint(screenshot, origTiles, object.data());
+        }
+    }
+    return changed;
+}
+
+QVector<ExportRenderer::Cluster> ExportRenderer::clusters(
+  const QRect& logicalSelection) const
+{
+    QVector<CaptureTool*> tools;
+    QVector<QRect> rects;
+    for (const auto& object : m_objects) {
+        if (object.isNull() || object->boundingRect().isNull()) {
+            continue;
+        }
+        tools << object.data();
+        rects << object->paintedRect();
+    }
+
+    // Group the overlapping objects together
+    QVector<int> parents(tools.size());
+    for (int i = 0; i < parents.size(); ++i) {
+        parents[i] = i;
+    }
+    for (int i = 0; i < rects.size(); ++i) {
+        for (int j = i + 1; j < rects.size(); ++j) {
+            if (rects[i].intersects(rects[j])) {
+                parents[findRoot(parents, j)] = findRoot(parents, i);
+            }
+        }
+    }
+
+    // Keep the drawing order of the objects inside of each cluster
+    QVector<Cluster> result;
+    QHash<int, int> clusterOfRoot;
+    for (int i = 0; i < tools.size(); ++i) {
+        int root = findRoot(parents, i);
+        if (!clusterOfRoot.contains(root)) {
+            clusterOfRoot.insert(root, result.size());
+            result.append(Cluster());
+        }
+        Cluster& cluster = result[clusterOfRoot.value(root)];
+        cluster.tools << tools[i];
+        cluster.region += rects[i];
+    }
+
+    // Clusters out of the selection don't change the exported image
+    QVector<Cluster> visible;
+    for (const Cluster& cluster : result) {
+        if (cluster.region.intersects(logicalSelection)) {
+            visible << cluster;
+        }
+    }
+    return visible;
+}
+
+int ExportRenderer::alignmentStep() const
+{
+    // Smallest logical offset that is a whole number of device pixels
+    for (int step = 1; step <= 256; ++step) {
+        qreal deviceOffset = step * m_devicePixelRatio;
+        if (qFuzzyCompare(deviceOffset, std::round(deviceOffset))) {
+            return step;
+        }
+    }
+    return 0;
+}
+
+QRect ExportRenderer::toDeviceRect(const QRect& logicalRect) const
+{
+    return QRectF(logicalRect.x() * m_devicePixelRatio,
+                  logicalRect.y() * m_devicePixelRatio,
+                  logicalRect.width() * m_devicePixelRatio,
+                  logicalRect.height() * m_devicePixelRatio)
+      .toAlignedRect();
+}
+
+bool ExportRenderer::readsPixmap(const CaptureTool* tool)
+{
+    return tool->type() == CaptureTool::TYPE_PIXELATE ||
+           tool->type() == CaptureTool::TYPE_INVERT;
+}
+
+void ExportRenderer::renderCluster(Cluster& cluster)
+{
+    for (CaptureTool* tool : cluster.tools) {
+        // A new painter for every object, like in paint()
+        QPainter painter(&cluster.canvas);
+        painter.setRenderHint(QPainter::Antialiasing);
+        painter.translate(-cluster.bounds.topLeft());
+        tool->process(painter, cluster.canvas);
+    }
+}
@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include "src/tools/capturetool.h"
+#include "src/utils/imagetilestore.h"
+#include <QList>
+#include <QPixmap>
+#include <QPointer>
+#include <QRegion>
+#include <QVector>
+
+// Renders the final image of a capture from the original screenshot and the
+// ordered list of capture tool objects.
+//
+// The objects are split into clusters of overlapping objects. Objects of
+// different clusters never paint or read the same pixels, so each cluster is
+// rendered on its own tile of the screenshot by a thread pool and the tiles
+// are composited afterwards. The result is the same as replaying all the
+// objects over the whole screenshot like CaptureWidget::drawToolsData().
+class ExportRenderer
+{
+public:
+    ExportRenderer(const QPixmap& screenshot,
+                   const ImageTileStore& origTiles,
+                   const QList<QPointer<CaptureTool>>& objects);
+
+    // Render the area `selection` (device pixels) of the capture. A null
+    // selection renders the whole screenshot. Returns a null pixmap when the
+    // objects can't be split, when one may paint anywhere or reads pixels
+    // past the screen, so the caller takes the replayed screenshot instead.
+    QPixmap render(const QRect& selection) const;
+
+    // Logical area of `screenshot` that processing `tool` may paint on, the
+    // whole screenshot when the tool can't tell
+    static QRect paintedRect(const CaptureTool* tool,
+                             const QPixmap& screenshot);
+    // Paint `tool` on the working `screenshot` of the editor, saving the
+    // tiles it paints over into `origTiles` first. Returns the painted area.
+    static QRect paint(QPixmap& screenshot,
+                       ImageTileStore& origTiles,
+                       CaptureTool* tool);
+    // Revert the working `screenshot` to the original one and paint all the
+    // `objects` on it again. Returns the area that has changed.
+    static QRegion replay(QPixmap& screenshot,
+                          ImageTileStore& origTiles,
+                          const QList<QPointer<CaptureTool>>& objects);
+
+private:
+    struct Cluster
+    {
+        QList<CaptureTool*> tools;
+        QRegion region;
+        QRect bounds;
+        QPixmap canvas;
+    };
+
+    QVector<Cluster> clusters(const QRect& logicalSelection) const;
+    int alignmentStep() const;
+    QRect toDeviceRect(const QRect& logicalRect) const;
+    static bool readsPixmap(const CaptureTool* tool);
+    static void renderCluster(Cluster& cluster);
+
+    const QPixmap& m_screenshot;
+    const ImageTileStore& m_origTiles;
+    QList<QPointer<CaptureTool>> m_objects;
+    qreal m_devicePixelRatio;
+};
@@ -0,0 +1,178 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "recordwidget.h"
+#include "abstractlogger.h"
+#include "src/core/flameshot.h"
+#include "src/utils/confighandler.h"
+#include "src/utils/filenamehandler.h"
+#include "src/utils/gifencoder.h"
+#include "src/utils/metrics.h"
+#include <QDir>
+#include <QFile>
+#include <QMutex>
+#include <QQueue>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThread>
+#include <QWaitCondition>
+
+// Frames waiting for the encoder, more are dropped
+#define MAX_QUEUED_FRAMES 8
+
+class GifEncoderThread : public QThread
+{
+public:
+    explicit GifEncoderThread(const QString& path)
+      : m_path(path)
+      , m_finishing(false)
+      , m_canceled(false)
+      , m_end(0)
+      , m_ok(false)
+    {}
+
+    // False when the encoder is behind
+    bool push(const QImage& frame, qint64 timestamp)
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_frames.size() >= MAX_QUEUED_FRAMES) {
+            return false;
+        }
+        m_frames.enqueue(qMakePair(frame, timestamp));
+        m_condition.wakeOne();
+        return true;
+    }
+
+    // Encodes the queued frames, the last one lasts until `timestamp`
+    void finish(qint64 timestamp)
+    {
+        QMutexLocker locker(&m_mutex);
+        m_finishing = true;
+        m_end = timestamp;
+        m_condition.wakeOne();
+    }
+
+    void cancel()
+    {
+        QMutexLocker locker(&m_mutex);
+        m_finishing = true;
+        m_canceled = true;
+        m_frames.clear();
+        m_condition.wakeOne();
+    }
+
+    bool ok() const { return m_ok; }
+
+protected:
+    void run() override
+    {
+        QSaveFile file(m_path);
+        if (!file.open(QIODevice::WriteOnly)) {
+            return;
+        }
+        GifEncoder encoder(&file);
+        bool ok = true;
+        while (true) {
+            QMutexLocker locker(&m_mutex);
+            while (m_frames.isEmpty() && !m_finishing) {
+                m_condition.wait(&m_mutex);
+            }
+            if (m_frames.isEmpty()) {
+                break;
+            }
+            auto frame = m_frames.dequeue();
+            locker.unlock();
+            Metrics::Timer timer(QStringLiteral("recordFrame"));
+            ok = encoder.addFrame(frame.first, frame.second) && ok;
+        }
+        // Not committed when canceled, the file is left as it was
+        m_ok = !m_canceled && ok && encoder.finish(m_end) && file.commit();
+    }
+
+private:
+    QString m_path;
+    QMutex m_mutex;
+    QWaitCondition m_condition;
+    QQueue<QPair<QImage, qint64>> m_frames;
+    bool m_finishing;
+    bool m_canceled;
+    qint64 m_end;
+    bool m_ok;
+};
+
+RecordWidget::RecordWidget(const CaptureRequest& req,
+                           const QRect& region,
+                           int fps,
+                           int duration,
+                           QWidget* parent)
+  : RegionGrabWidget(req, region, 1000 / qBound(1, fps, 50), parent)
+  , m_encoder(nullptr)
+  , m_duration(duration)
+  , m_droppedFrames(0)
+{
+    // A file or a directory, like the path of the captures
+    QString path = req.path();
+    if (path.isEmpty()) {
+        path = ConfigHandler().savePath();
+        if (path.isEmpty() || !QDir(path).exists()) {
+            path = QStandardPaths::writableLocation(
+              QStandardPaths::PicturesLocation);
+        }
+    }
+    FilenameContext context;
+    context.captureId = req.id();
+    m_path = FileNameHandler().properScreenshotPath(path, "gif", true, context);
+
+    m_encoder = new GifEncoderThread(m_path);
+    m_encoder->start();
+    setStatus(tr("Recording"));
+}
+
+RecordWidget::~RecordWidget()
+{
+    if (captureDone()) {
+        m_encoder->finish(m_clock.isValid() ? m_clock.elapsed() : 0);
+    } else {
+        m_encoder->cancel();
+    }
+    m_encoder->wait();
+    const bool ok = captureDone() && m_encoder->ok();
+    delete m_encoder;
+
+    if (ok) {
+        AbstractLogger::info().attachNotificationPath(m_path)
+          << tr("Recording saved as ") + m_path;
+        if (m_droppedFrames > 0) {
+            AbstractLogger::info(AbstractLogger::LogFile)
+              << QStringLiteral("Recording dropped %1 frames")
+                   .arg(m_droppedFrames);
+        }
+        emit Flameshot::instance()->captureTaken(
+          QPixmap::fromImage(m_lastFrame));
+    } else {
+        // Remove the file reserved for the recording
+        QFile::remove(m_path);
+        if (captureDone()) {
+            AbstractLogger::error()
+              << tr("Error trying to save as ") + m_path;
+        }
+        emit Flameshot::instance()->captureFailed();
+    }
+}
+
+void RecordWidget::processFrame(const QImage& frame)
+{
+    if (!m_clock.isValid()) {
+        m_clock.start();
+    }
+    const qint64 timestamp = m_clock.elapsed();
+    if (m_encoder->push(frame, timestamp)) {
+        m_lastFrame = frame;
+    } else {
+        ++m_droppedFrames;
+    }
+    setStatus(tr("Recording %1 s").arg(timestamp / 1000));
+    if (m_duration > 0 && timestamp >= m_duration * 1000) {
+        finish();
+    }
+}
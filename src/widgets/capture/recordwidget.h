@@ -0,0 +1,39 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include "regiongrabwidget.h"
+#include <QElapsedTimer>
+
+class GifEncoderThread;
+
+// Records a region of the screen to an animated GIF. The frames are grabbed
+// on the GUI thread and encoded by a GifEncoder on another one. When the
+// encoder falls behind, frames are dropped and the previous one lasts
+// longer, the timing of the animation is kept.
+class RecordWidget : public RegionGrabWidget
+{
+    Q_OBJECT
+
+public:
+    // `region` is in global logical coordinates, a `duration` of 0 records
+    // until the user is done
+    RecordWidget(const CaptureRequest& req,
+                 const QRect& region,
+                 int fps,
+                 int duration,
+                 QWidget* parent = nullptr);
+    ~RecordWidget() override;
+
+protected:
+    void processFrame(const QImage& frame) override;
+
+private:
+    QString m_path;
+    GifEncoderThread* m_encoder;
+    QElapsedTimer m_clock;
+    QImage m_lastFrame;
+    int m_duration;
+    int m_droppedFrames;
+};
@@ -0,0 +1,170 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "regiongrabwidget.h"
+#include "abstractlogger.h"
+#include "src/utils/desktopinfo.h"
+#include "src/utils/screengrabber.h"
+#include <QApplication>
+#include <QHBoxLayout>
+#include <QKeyEvent>
+#include <QLabel>
+#include <QPushButton>
+#include <QScreen>
+#include <QTimer>
+
+// Time for the region selector to disappear before the first grab
+#define FIRST_GRAB_DELAY_MS 300
+#define REGION_SPACING 8
+
+RegionGrabWidget::RegionGrabWidget(const CaptureRequest& req,
+                                   const QRect& region,
+                                   int intervalMs,
+                                   QWidget* parent)
+  : QWidget(parent)
+  , m_request(req)
+  , m_region(region.normalized())
+  , m_screen(qApp->screenAt(m_region.center()))
+  , m_timer(new QTimer(this))
+  , m_status(new QLabel(this))
+  , m_captureDone(false)
+{
+    setAttribute(Qt::WA_DeleteOnClose);
+    setAttribute(Qt::WA_QuitOnClose, false);
+    // The grabbed window keeps the keyboard focus
+    setAttribute(Qt::WA_ShowWithoutActivating);
+    setWindowFlags(Qt::WindowStaysOnTopHint | Qt::FramelessWindowHint |
+                   Qt::Tool);
+
+    auto* doneButton = new QPushButton(tr("Done"), this);
+    auto* cancelButton = new QPushButton(tr("Cancel"), this);
+    connect(doneButton, &QPushButton::clicked, this, [this]() { finish(); });
+    connect(cancelButton, &QPushButton::clicked, this, &QWidget::close);
+    auto* layout = new QHBoxLayout(this);
+    layout->addWidget(m_status);
+    layout->addWidget(doneButton);
+    layout->addWidget(cancelButton);
+
+    if (m_screen == nullptr || m_region.isEmpty()) {
+        AbstractLogger::error() << tr("Unable to capture screen");
+        QTimer::singleShot(0, this, &QWidget::close);
+        return;
+    }
+    m_timer->setInterval(intervalMs);
+    m_timer->setTimerType(Qt::PreciseTimer);
+    connect(m_timer, &QTimer::timeout, this, &RegionGrabWidget::grabFrame);
+    QTimer::singleShot(FIRST_GRAB_DELAY_MS, this, [this]() {
+        if (!m_captureDone) {
+            grabFrame();
+            m_timer->start();
+        }
+    });
+}
+
+void RegionGrabWidget::keyPressEvent(QKeyEvent* event)
+{
+    if (event->key() == Qt::Key_Escape) {
+        close();
+    } else if (event->key() == Qt::Key_Enter ||
+               event->key() == Qt::Key_Return) {
+        finish();
+    }
+}
+
+void RegionGrabWidget::setStatus(const QString& status)
+{
+    m_status->setText(status);
+    if (m_screen != nullptr && !isVisible()) {
+        adjustSize();
+        placeNextToRegion();
+    }
+}
+
+void RegionGrabWidget::stopGrabbing()
+{
+    m_timer->stop();
+}
+
+void RegionGrabWidget::finish()
+{
+    m_timer->stop();
+    m_captureDone = true;
+    close();
+}
+
+bool RegionGrabWidget::captureDone() const
+{
+    return m_captureDone;
+}
+
+const CaptureRequest& RegionGrabWidget::request() const
+{
+    return m_request;
+}
+
+const QRect& RegionGrabWidget::region() const
+{
+    return m_region;
+}
+
+void RegionGrabWidget::grabFrame()
+{
+    if (m_screen == nullptr) {
+        close();
+        return;
+    }
+    QPixmap frame;
+    if (DesktopInfo().waylandDetected()) {
+        // The portals only grab whole screens
+        bool ok = true;
+        ScreenGrabber grabber;
+        QPixmap screenshot = grabber.grabScreen(m_screen, ok);
+        if (ok) {
+            // The region in the pixels of the screenshot
+            const qreal ratio = screenshot.devicePixelRatio();
+            const QRect local =
+              m_region.translated(-grabber.screenGeometry(m_screen).topLeft());
+            frame = screenshot.copy(
+              static_cast<int>(local.left() * ratio),
+              static_cast<int>(local.top() * ratio),
+              static_cast<int>(local.width() * ratio),
+              static_cast<int>(local.height() * ratio));
+        }
+    } else {
+        // ScreenGrabber takes the screen under the cursor on X11, the region
+        // is grabbed from its own screen instead
+        const QRect local =
+          m_region.translated(-m_screen->geometry().topLeft());
+        frame = m_screen->grabWindow(
+          0, local.x(), local.y(), local.width(), local.height());
+    }
+    if (frame.isNull()) {
+        AbstractLogger::error() << tr("Unable to capture screen");
+        close();
+        return;
+    }
+    processFrame(frame.toImage());
+}
+
+// Below the region, or above it, or beside it, as long as it stays on the
+// screen and out of the region
+void RegionGrabWidget::placeNextToRegion()
+{
+    const QRect available = m_screen->availableGeometry();
+    const QSize size = sizeHint();
+    const QVector<QPoint> candidates = {
+        { m_region.left(), m_region.bottom() + REGION_SPACING },
+        { m_region.left(), m_region.top() - REGION_SPACING - size.height() },
+        { m_region.right() + REGION_SPACING, m_region.top() },
+        { m_region.left() - REGION_SPACING - size.width(), m_region.top() },
+    };
+    for (const QPoint& candidate : candidates) {
+        QRect place(candidate, size);
+        if (available.contains(place)) {
+            move(place.topLeft());
+            return;
+        }
+    }
+    // The region covers the screen, the bar ends up in the frames
+    move(available.bottomRight() - QPoint(size.width(), size.height()));
+}
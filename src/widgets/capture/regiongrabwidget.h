@@ -0,0 +1,53 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include "src/core/capturerequest.h"
+#include <QPointer>
+#include <QWidget>
+
+class QLabel;
+class QScreen;
+class QTimer;
+
+// Grabs a region of the screen at a fixed interval until the user is done.
+// The widget is a small bar with a status and the buttons, placed next to
+// the region so it is not grabbed along with it. Subclasses get the frames
+// in processFrame() and export what they made of them when destroyed after
+// finish().
+class RegionGrabWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    // `region` is in global logical coordinates
+    RegionGrabWidget(const CaptureRequest& req,
+                     const QRect& region,
+                     int intervalMs,
+                     QWidget* parent = nullptr);
+
+protected:
+    // `frame` is in physical pixels
+    virtual void processFrame(const QImage& frame) = 0;
+
+    void keyPressEvent(QKeyEvent* event) override;
+
+    void setStatus(const QString& status);
+    void stopGrabbing();
+    void finish();
+    bool captureDone() const;
+    const CaptureRequest& request() const;
+    const QRect& region() const;
+
+private:
+    void grabFrame();
+    void placeNextToRegion();
+
+    CaptureRequest m_request;
+    QRect m_region;
+    QPointer<QScreen> m_screen;
+    QTimer* m_timer;
+    QLabel* m_status;
+    bool m_captureDone;
+};
@@ -0,0 +1,46 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "scrollcapturewidget.h"
+#include "src/core/flameshot.h"
+
+#define GRAB_INTERVAL_MS 150
+
+ScrollCaptureWidget::ScrollCaptureWidget(const CaptureRequest& req,
+                                         const QRect& region,
+                                         QWidget* parent)
+  : RegionGrabWidget(req, region, GRAB_INTERVAL_MS, parent)
+{
+    setStatus(tr("Scroll the content down"));
+}
+
+ScrollCaptureWidget::~ScrollCaptureWidget()
+{
+    QImage result = captureDone() ? m_stitcher.result() : QImage();
+    if (!result.isNull()) {
+        QRect geometry(region().topLeft(),
+                       result.size() / result.devicePixelRatio());
+        Flameshot::instance()->exportCapture(
+          QPixmap::fromImage(result), geometry, request());
+    } else {
+        emit Flameshot::instance()->captureFailed();
+    }
+}
+
+void ScrollCaptureWidget::processFrame(const QImage& frame)
+{
+    switch (m_stitcher.addFrame(frame)) {
+        case ScrollStitcher::FRAME_STITCHED:
+        case ScrollStitcher::FRAME_UNCHANGED:
+            setStatus(tr("Scroll the content down, %1 px captured")
+                        .arg(m_stitcher.height()));
+            break;
+        case ScrollStitcher::FRAME_NOT_ALIGNED:
+            setStatus(tr("Scrolled too far, scroll back up a little"));
+            break;
+        case ScrollStitcher::FRAME_FULL:
+            stopGrabbing();
+            setStatus(tr("Maximum height reached"));
+            break;
+    }
+}
@@ -0,0 +1,27 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include "regiongrabwidget.h"
+#include "src/utils/scrollstitcher.h"
+
+// Grabs a region of the screen again and again while the user scrolls its
+// content, and exports the frames stitched by a ScrollStitcher once done.
+class ScrollCaptureWidget : public RegionGrabWidget
+{
+    Q_OBJECT
+
+public:
+    // `region` is in global logical coordinates
+    explicit ScrollCaptureWidget(const CaptureRequest& req,
+                                 const QRect& region,
+                                 QWidget* parent = nullptr);
+    ~ScrollCaptureWidget() override;
+
+protected:
+    void processFrame(const QImage& frame) override;
+
+private:
+    ScrollStitcher m_stitcher;
+};
@@ -0,0 +1,176 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "selectorwidget.h"
+#include "abstractlogger.h"
+#include "src/config/cacheutils.h"
+#include "src/core/flameshot.h"
+#include "src/utils/confighandler.h"
+#include "src/utils/screengrabber.h"
+#include "src/widgets/capture/selectionwidget.h"
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QTimer>
+
+SelectorWidget::SelectorWidget(const CaptureRequest& req, QWidget* parent)
+  : QWidget(parent)
+  , m_request(req)
+  , m_selection(nullptr)
+  , m_captureDone(false)
+{
+    ConfigHandler config;
+    m_opacity = config.contrastOpacity();
+    setAttribute(Qt::WA_DeleteOnClose);
+    setAttribute(Qt::WA_QuitOnClose, false);
+    setMouseTracking(true);
+    setCursor(Qt::CrossCursor);
+    m_widgetOffset = mapToGlobal(QPoint(0, 0));
+
+    bool ok = true;
+    m_screenshot = ScreenGrabber().grabEntireDesktop(ok);
+    if (!ok) {
+        AbstractLogger::error() << tr("Unable to capture screen");
+        this->close();
+    }
+// Call cmake with -DFLAMESHOT_DEBUG_CAPTURE=ON to enable easier debugging
+#if !defined(FLAMESHOT_DEBUG_CAPTURE)
+    setWindowFlags(Qt::BypassWindowManagerHint | Qt::WindowStaysOnTopHint |
+                   Qt::FramelessWindowHint | Qt::Tool);
+    resize(m_screenshot.size());
+#endif
+
+    m_selection = new SelectionWidget(config.uiColor(), this);
+    connect(m_selection, &SelectionWidget::geometryChanged, this, [this]() {
+        update();
+    });
+    connect(m_selection, &SelectionWidget::geometrySettled, this, [this]() {
+        update();
+        if (m_selection->isVisibleTo(this) &&
+            (m_request.tasks() & CaptureRequest::ACCEPT_ON_SELECT)) {
+            accept();
+        }
+    });
+
+    // Same as the initial selection of the capture widget
+    QRect initialSelection = m_request.initialSelection();
+    if (!initialSelection.isNull()) {
+        const qreal scale = m_screenshot.devicePixelRatio();
+        initialSelection.moveTopLeft(initialSelection.topLeft() -
+                                     mapToGlobal({}));
+        initialSelection.setTop(initialSelection.top() / scale);
+        initialSelection.setBottom(initialSelection.bottom() / scale);
+        initialSelection.setLeft(initialSelection.left() / scale);
+        initialSelection.setRight(initialSelection.right() / scale);
+    }
+    m_selection->setGeometry(initialSelection);
+    m_selection->setVisible(!initialSelection.isNull());
+    if (!initialSelection.isNull()) {
+        emit m_selection->geometrySettled();
+    }
+}
+
+SelectorWidget::~SelectorWidget()
+{
+    if (m_captureDone &&
+        m_request.captureMode() != CaptureRequest::GRAPHICAL_MODE) {
+        emit regionSelected(m_selection->geometry().normalized().translated(
+          m_widgetOffset));
+    } else if (m_captureDone) {
+        setLastRegion(m_selection->geometry());
+        QRect geometry = selection();
+        QPixmap capture = m_screenshot.copy(geometry);
+        geometry.moveTo(geometry.topLeft() + m_widgetOffset);
+        Flameshot::instance()->exportCapture(
+          capture,
+          geometry,
+          m_request,
+          m_selection->geometry().normalized().translated(m_widgetOffset));
+    } else {
+        emit Flameshot::instance()->captureFailed();
+    }
+}
+
+bool SelectorWidget::handles(const CaptureRequest& req)
+{
+#if defined(Q_OS_WIN) || defined(Q_OS_MACOS)
+    // The window setup of the capture widget is specific to these platforms
+    Q_UNUSED(req)
+    return false;
+#else
+    return req.captureMode() == CaptureRequest::GRAPHICAL_MODE &&
+           ((req.tasks() & CaptureRequest::ACCEPT_ON_SELECT) ||
+            req.tasks() == CaptureRequest::PRINT_GEOMETRY);
+#endif
+}
+
+void SelectorWidget::paintEvent(QPaintEvent* event)
+{
+    Q_UNUSED(event)
+    QPainter painter(this);
+    painter.drawPixmap(0, 0, m_screenshot);
+
+    QRegion grey(rect());
+    if (m_selection->isVisible()) {
+        grey = grey.subtracted(m_selection->geometry().normalized());
+    }
+    painter.setClipRegion(grey);
+    painter.fillRect(rect(), QColor(0, 0, 0, m_opacity));
+}
+
+void SelectorWidget::keyPressEvent(QKeyEvent* event)
+{
+    if (event->key() == Qt::Key_Escape) {
+        close();
+    } else if ((event->key() == Qt::Key_Enter ||
+                event->key() == Qt::Key_Return) &&
+               m_selection->isVisible()) {
+        accept();
+    }
+}
+
+// The window bypasses the window manager, so like the CaptureWidget it has to
+// take the keyboard focus itself for Escape and Enter to arrive
+void SelectorWidget::mousePressEvent(QMouseEvent* event)
+{
+    activateWindow();
+    QWidget::mousePressEvent(event);
+}
+
+void SelectorWidget::mouseDoubleClickEvent(QMouseEvent* event)
+{
+    if (event->button() == Qt::LeftButton && m_selection->isVisible() &&
+        m_selection->geometry().contains(event->pos())) {
+        accept();
+    }
+}
+
+void SelectorWidget::showEvent(QShowEvent* event)
+{
+    QWidget::showEvent(event);
+    QTimer::singleShot(500, this, [this]() {
+        activateWindow();
+        setFocus();
+    });
+}
+
+void SelectorWidget::accept()
+{
+    if (m_captureDone) {
+        return;
+    }
+    m_request.removeTask(CaptureRequest::ACCEPT_ON_SELECT);
+    m_captureDone = true;
+    close();
+}
+
+// Selection in the pixels of the screenshot
+QRect SelectorWidget::selection() const
+{
+    const QRect r = m_selection->geometry().normalized().intersected(rect());
+    const qreal ratio = m_screenshot.devicePixelRatio();
+    return { static_cast<int>(r.left() * ratio),
+             static_cast<int>(r.top() * ratio),
+             static_cast<int>(r.width() * ratio),
+             static_cast<int>(r.height() * ratio) };
+}
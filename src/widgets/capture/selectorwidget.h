@@ -0,0 +1,51 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include "src/core/capturerequest.h"
+#include <QPixmap>
+#include <QWidget>
+
+class SelectionWidget;
+
+// Selection-only overlay for the requests that only need a region, see
+// handles(). It shows the screenshot with a SelectionWidget and nothing
+// else: no tool buttons, panels, color picker, magnifier or undo stack.
+// The selected region is exported like the CaptureWidget does it. For the
+// other capture modes it is only announced with regionSelected().
+class SelectorWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit SelectorWidget(const CaptureRequest& req,
+                            QWidget* parent = nullptr);
+    ~SelectorWidget() override;
+
+    // True when the capture can't be annotated before it is exported:
+    // accepted as soon as a region is selected, or only its geometry printed
+    static bool handles(const CaptureRequest& req);
+
+signals:
+    // Selected region in global logical coordinates
+    void regionSelected(const QRect& region);
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void keyPressEvent(QKeyEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
+    void mouseDoubleClickEvent(QMouseEvent* event) override;
+    void showEvent(QShowEvent* event) override;
+
+private:
+    void accept();
+    QRect selection() const;
+
+    CaptureRequest m_request;
+    QPixmap m_screenshot;
+    QPoint m_widgetOffset;
+    SelectionWidget* m_selection;
+    int m_opacity;
+    bool m_captureDone;
+};
@@ -0,0 +1,103 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "layerlistmodel.h"
+#include "src/widgets/capture/capturetoolobjects.h"
+#include <QCoreApplication>
+
+// Row of the object at `index`, the first row is the "<Empty>" one
+#define ROW(index) ((index) + 1)
+
+LayerListModel::LayerListModel(QObject* parent)
+  : QAbstractListModel(parent)
+{}
+
+void LayerListModel::setCaptureToolObjects(CaptureToolObjects* objects)
+{
+    beginResetModel();
+    if (m_objects) {
+        disconnect(m_objects, nullptr, this, nullptr);
+    }
+    m_objects = objects;
+    endResetModel();
+    if (!m_objects) {
+        return;
+    }
+
+    connect(m_objects,
+            &CaptureToolObjects::objectsAboutToBeInserted,
+            this,
+            [this](int first, int last) {
+                beginInsertRows(QModelIndex(), ROW(first), ROW(last));
+            });
+    connect(m_objects,
+            &CaptureToolObjects::objectsInserted,
+            this,
+            &LayerListModel::endInsertRows);
+    connect(m_objects,
+            &CaptureToolObjects::objectsAboutToBeRemoved,
+            this,
+            [this](int first, int last) {
+                beginRemoveRows(QModelIndex(), ROW(first), ROW(last));
+            });
+    connect(m_objects,
+            &CaptureToolObjects::objectsRemoved,
+            this,
+            &LayerListModel::endRemoveRows);
+    connect(m_objects,
+            &CaptureToolObjects::objectAboutToBeMoved,
+            this,
+            [this](int from, int to) {
+                // The destination is the row the object is inserted before
+                int destination = to > from ? ROW(to) + 1 : ROW(to);
+                beginMoveRows(QModelIndex(),
+                              ROW(from),
+                              ROW(from),
+                              QModelIndex(),
+                              destination);
+            });
+    connect(m_objects,
+            &CaptureToolObjects::objectMoved,
+            this,
+            &LayerListModel::endMoveRows);
+    connect(m_objects,
+            &CaptureToolObjects::objectsChanged,
+            this,
+            [this](int first, int last) {
+                emit dataChanged(index(ROW(first)), index(ROW(last)));
+            });
+}
+
+int LayerListModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return m_objects ? ROW(m_objects->size()) : 1;
+}
+
+QVariant LayerListModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= rowCount()) {
+        return QVariant();
+    }
+    if (index.row() == 0) {
+        // Keeps the translations made when the panel filled a QListWidget
+        return role == Qt::DisplayRole
+                 ? QCoreApplication::translate("UtilityPanel", "<Empty>")
+                 : QVariant();
+    }
+
+    QPointer<CaptureTool> tool = m_objects->at(index.row() - 1);
+    if (!tool) {
+        return QVariant();
+    }
+    switch (role) {
+        case Qt::DisplayRole:
+            return tool->info();
+        case Qt::DecorationRole:
+            return tool->icon(QColor(Qt::white), false);
+        default:
+            return QVariant();
+    }
+}
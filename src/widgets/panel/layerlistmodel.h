@@ -0,0 +1,28 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#pragma once
+
+#include <QAbstractListModel>
+#include <QPointer>
+
+class CaptureToolObjects;
+
+// Layers of the utility panel: an "<Empty>" row followed by the objects of
+// the capture, bottom to top. The rows are read from the CaptureToolObjects
+// directly and follow its signals, so a change only touches the rows it
+// concerns and the view asks for the text and icon of the visible ones.
+class LayerListModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    explicit LayerListModel(QObject* parent = nullptr);
+
+    void setCaptureToolObjects(CaptureToolObjects* objects);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role) const override;
+
+private:
+    QPointer<CaptureToolObjects> m_objects;
+};
@@ -5,6 +5,7 @@
 #include "colorgrabwidget.h"
 #include "src/core/qguiappcurrentscreen.h"
 #include "src/utils/colorutils.h"
+#include "src/utils/iconatlas.h"
 #include "src/utils/pathinfo.h"
 #include "utilitypanel.h"
 #include <QApplication>
@@ -74,7 +75,7 @@ SidePanelWidget::SidePanelWidget(QPixmap* p, QWidget* parent)
     bool isDark = ColorUtils::colorIsDark(background);
     QString modifier =
       isDark ? PathInfo::whiteIconPath() : PathInfo::blackIconPath();
-    QIcon grabIcon(modifier + "colorize.svg");
+    QIcon grabIcon = IconAtlas::icon(modifier + "colorize.svg");
     m_colorGrabButton = new QPushButton(grabIcon, tr("Grab Color"));
 
     m_layout->addWidget(m_colorGrabButton);
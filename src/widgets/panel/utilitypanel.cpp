@@ -3,11 +3,14 @@
 
 #include "utilitypanel.h"
 #include "capturewidget.h"
+#include "layerlistmodel.h"
+#include "src/utils/iconatlas.h"
 #include <QHBoxLayout>
-#include <QListWidget>
+#include <QListView>
 #include <QPropertyAnimation>
 #include <QPushButton>
 #include <QScrollArea>
+#include <QSignalBlocker>
 #include <QTimer>
 
 UtilityPanel::UtilityPanel(CaptureWidget* captureWidget)
@@ -21,6 +24,7 @@ UtilityPanel::UtilityPanel(CaptureWidget* captureWidget)
   , m_hideAnimation(nullptr)
   , m_layersLayout(nullptr)
   , m_captureTools(nullptr)
+  , m_layersModel(nullptr)
   , m_buttonDelete(nullptr)
   , m_buttonMoveUp(nullptr)
   , m_buttonMoveDown(nullptr)
@@ -135,11 +139,25 @@ void UtilityPanel::initInternalPanel()
       QStringLiteral("QScrollArea {background-color: %1}").arg(bgColor.name()));
     m_internalPanel->hide();
 
-    m_captureTools = new QListWidget(this);
-    connect(m_captureTools,
-            &QListWidget::currentRowChanged,
+    m_layersModel = new LayerListModel(this);
+    m_captureTools = new QListView(this);
+    m_captureTools->setUniformItemSizes(true);
+    m_captureTools->setModel(m_layersModel);
+    connect(m_captureTools->selectionModel(),
+            &QItemSelectionModel::currentRowChanged,
             this,
-            &UtilityPanel::onCurrentRowChanged);
+            [this](const QModelIndex& current) {
+                onCurrentRowChanged(current.row());
+            });
+    // Adding or removing objects can enable or disable the move buttons
+    connect(m_layersModel,
+            &QAbstractItemModel::rowsInserted,
+            this,
+            &UtilityPanel::updateLayerButtons);
+    connect(m_layersModel,
+            &QAbstractItemModel::rowsRemoved,
+            this,
+            &UtilityPanel::updateLayerButtons);
 
     auto* layersButtons = new QHBoxLayout();
     m_layersLayout->addLayout(layersButtons);
@@ -151,17 +169,18 @@ void UtilityPanel::initInternalPanel()
       isDark ? PathInfo::whiteIconPath() : PathInfo::blackIconPath();
 
     m_buttonDelete = new QPushButton(this);
-    m_buttonDelete->setIcon(QIcon(coloredIconPath + "delete.svg"));
+    m_buttonDelete->setIcon(IconAtlas::icon(coloredIconPath + "delete.svg"));
     m_buttonDelete->setMinimumWidth(m_buttonDelete->height());
     m_buttonDelete->setDisabled(true);
 
     m_buttonMoveUp = new QPushButton(this);
-    m_buttonMoveUp->setIcon(QIcon(coloredIconPath + "move_up.svg"));
+    m_buttonMoveUp->setIcon(IconAtlas::icon(coloredIconPath + "move_up.svg"));
     m_buttonMoveUp->setMinimumWidth(m_buttonMoveUp->height());
     m_buttonMoveUp->setDisabled(true);
 
     m_buttonMoveDown = new QPushButton(this);
-    m_buttonMoveDown->setIcon(QIcon(coloredIconPath + "move_down.svg"));
+    m_buttonMoveDown->setIcon(
+      IconAtlas::icon(coloredIconPath + "move_down.svg"));
     m_buttonMoveDown->setMinimumWidth(m_buttonMoveDown->height());
     m_buttonMoveDown->setDisabled(true);
 
@@ -192,76 +211,88 @@ void UtilityPanel::initInternalPanel()
     m_bottomLayout->addWidget(closeButton);
 }
 
-void UtilityPanel::fillCaptureTools(
-  const QList<QPointer<CaptureTool>>& captureToolObjects)
+void UtilityPanel::setCaptureToolObjects(
+  CaptureToolObjects* captureToolObjects)
 {
-    int currentSelection = m_captureTools->currentRow();
-    m_captureTools->clear();
-    m_captureTools->addItem(tr("<Empty>"));
-
-    for (auto toolItem : captureToolObjects) {
-        auto* item = new QListWidgetItem(
-          toolItem->icon(QColor(Qt::white), false), toolItem->info());
-        m_captureTools->addItem(item);
-    }
-    if (currentSelection >= 0 && currentSelection < m_captureTools->count()) {
-        m_captureTools->setCurrentRow(currentSelection);
-    }
+    m_layersModel->setCaptureToolObjects(captureToolObjects);
+}
+
+int UtilityPanel::currentRow() const
+{
+    return m_captureTools->currentIndex().row();
+}
+
+void UtilityPanel::setCurrentRow(int row)
+{
+    m_captureTools->setCurrentIndex(m_layersModel->index(row));
 }
 
 void UtilityPanel::setActiveLayer(int index)
 {
     Q_ASSERT(index >= -1);
-    m_captureTools->setCurrentRow(index + 1);
+    setCurrentRow(index + 1);
 }
 
 int UtilityPanel::activeLayerIndex()
 {
-    return m_captureTools->currentRow() >= 0 ? m_captureTools->currentRow() - 1
-                                             : -1;
+    return currentRow() >= 0 ? currentRow() - 1 : -1;
 }
 
 void UtilityPanel::onCurrentRowChanged(int currentRow)
 {
-    m_buttonDelete->setDisabled(currentRow <= 0);
-    m_buttonMoveDown->setDisabled(currentRow == 0 ||
-                                  currentRow + 1 == m_captureTools->count());
-    m_buttonMoveUp->setDisabled(currentRow <= 1);
-
+    Q_UNUSED(currentRow)
+    updateLayerButtons();
     emit layerChanged(activeLayerIndex());
 }
 
+void UtilityPanel::updateLayerButtons()
+{
+    const int row = currentRow();
+    m_buttonDelete->setDisabled(row <= 0);
+    m_buttonMoveDown->setDisabled(row <= 0 ||
+                                  row + 1 == m_layersModel->rowCount());
+    m_buttonMoveUp->setDisabled(row <= 1);
+}
+
 void UtilityPanel::slotUpClicked(bool clicked)
 {
     Q_UNUSED(clicked);
     // subtract 1 because there's <empty> in m_captureTools as [0] element
-    int toolRow = m_captureTools->currentRow() - 1;
-    m_captureTools->setCurrentRow(toolRow);
+    int toolRow = currentRow() - 1;
     emit moveUpClicked(toolRow);
+    // The current row has followed the moved object
+    onCurrentRowChanged(currentRow());
 }
 
 void UtilityPanel::slotDownClicked(bool clicked)
 {
     Q_UNUSED(clicked);
     // subtract 1 because there's <empty> in m_captureTools as [0] element
-    int toolRow = m_captureTools->currentRow() - 1;
-    m_captureTools->setCurrentRow(toolRow + 2);
+    int toolRow = currentRow() - 1;
     emit moveDownClicked(toolRow);
+    // The current row has followed the moved object
+    onCurrentRowChanged(currentRow());
 }
 
 void UtilityPanel::slotButtonDelete(bool clicked)
 {
     Q_UNUSED(clicked)
-    int currentRow = m_captureTools->currentRow();
-    if (currentRow > 0) {
-        m_captureWidget->removeToolObject(currentRow);
-        if (currentRow >= m_captureTools->count()) {
-            currentRow = m_captureTools->count() - 1;
+    int row = currentRow();
+    {
+        // The selection model moves the current row off the removed one on
+        // its own, the layer is announced once the final row is set
+        QSignalBlocker blocker(m_captureTools->selectionModel());
+        if (row > 0) {
+            m_captureWidget->removeToolObject(row);
+            if (row >= m_layersModel->rowCount()) {
+                row = m_layersModel->rowCount() - 1;
+            }
+        } else {
+            row = 0;
         }
-    } else {
-        currentRow = 0;
+        setCurrentRow(row);
     }
-    m_captureTools->setCurrentRow(currentRow);
+    onCurrentRowChanged(row);
 }
 
 bool UtilityPanel::isVisible() const
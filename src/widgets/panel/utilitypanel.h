@@ -11,9 +11,11 @@ class QVBoxLayout;
 class QPropertyAnimation;
 class QScrollArea;
 class QPushButton;
-class QListWidget;
+class QListView;
 class QPushButton;
 class CaptureWidget;
+class CaptureToolObjects;
+class LayerListModel;
 
 class UtilityPanel : public QWidget
 {
@@ -27,8 +29,7 @@ public:
     void pushWidget(QWidget* widget);
     void hide();
     void show();
-    void fillCaptureTools(
-      const QList<QPointer<CaptureTool>>& captureToolObjectsHistory);
+    void setCaptureToolObjects(CaptureToolObjects* captureToolObjects);
     void setActiveLayer(int index);
     int activeLayerIndex();
     bool isVisible() const;
@@ -49,6 +50,9 @@ private slots:
 
 private:
     void initInternalPanel();
+    int currentRow() const;
+    void setCurrentRow(int row);
+    void updateLayerButtons();
 
     QPointer<QWidget> m_toolWidget;
     QScrollArea* m_internalPanel;
@@ -58,7 +62,8 @@ private:
     QPropertyAnimation* m_showAnimation;
     QPropertyAnimation* m_hideAnimation;
     QVBoxLayout* m_layersLayout;
-    QListWidget* m_captureTools;
+    QListView* m_captureTools;
+    LayerListModel* m_layersModel;
     QPushButton* m_buttonDelete;
     QPushButton* m_buttonMoveUp;
     QPushButton* m_buttonMoveDown;
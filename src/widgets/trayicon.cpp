@@ -143,6 +143,19 @@ void TrayIcon::initMenu()
             &FlameshotDaemon::unsetAllMouseTransparent);
     m_unsetMouseTransparentAction->setEnabled(
         FlameshotDaemon::instance()->countMouseTransparent() > 0);
+    // Read-only entry showing the memory used by the pins
+    m_pinMemoryAction = new QAction(this);
+    m_pinMemoryAction->setEnabled(false);
+    m_pinMemoryAction->setVisible(false);
+    connect(m_menu, &QMenu::aboutToShow, this, [this]() {
+        auto* daemon = FlameshotDaemon::instance();
+        const qsizetype pins = daemon->countPins();
+        m_pinMemoryAction->setVisible(pins > 0);
+        m_pinMemoryAction->setText(
+          tr("Pins: %1 (%2 MiB)")
+            .arg(pins)
+            .arg(daemon->pinMemoryUsage() / (1024.0 * 1024.0), 0, 'f', 1));
+    });
     auto* configAction = new QAction(tr("&Configuration"), this);
     connect(configAction,
             &QAction::triggered,
@@ -189,6 +202,7 @@ void TrayIcon::initMenu()
     m_menu->addAction(delayCaptureAction);
     m_menu->addAction(launcherAction);
     m_menu->addAction(m_unsetMouseTransparentAction);
+    m_menu->addAction(m_pinMemoryAction);
     m_menu->addSeparator();
     m_menu->addAction(recentAction);
     m_menu->addAction(openSavePathAction);
@@ -29,6 +29,7 @@ private:
 
     QMenu* m_menu;
     QAction* m_unsetMouseTransparentAction;
+    QAction* m_pinMemoryAction;
 #if !defined(DISABLE_UPDATE_CHECKER)
     QAction* m_appUpdates;
 #endif
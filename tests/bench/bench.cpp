@@ -0,0 +1,333 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+// Benchmarks of the hot paths of flameshot, see CMakeLists.txt. Every
+// benchmark runs its body until it has taken at least MIN_TIME_MS and
+// reports the minimum, median and mean time of one run in nanoseconds.
+
+#include "src/tools/capturecontext.h"
+#include "src/tools/capturetool.h"
+#include "src/tools/toolfactory.h"
+#include "src/utils/confighandler.h"
+#include "src/utils/history.h"
+#include "src/utils/imagetilestore.h"
+#include "src/utils/screenshotsaver.h"
+#include "src/widgets/capture/capturetoolobjects.h"
+#include "src/widgets/capture/exportrenderer.h"
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDBusMessage>
+#include <QDataStream>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPainter>
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+namespace {
+constexpr qint64 MIN_TIME_MS = 200;
+constexpr int MIN_ITERATIONS = 5;
+constexpr int MAX_ITERATIONS = 10000;
+
+const QSize CAPTURE_SIZE(1920, 1080);
+
+class Bench
+{
+public:
+    explicit Bench(QString filter)
+      : m_filter(std::move(filter))
+    {}
+
+    void run(const QString& name, const std::function<void()>& body)
+    {
+        if (!m_filter.isEmpty() && !name.contains(m_filter)) {
+            return;
+        }
+        // warm up caches and lazily initialized state
+        body();
+
+        QVector<qint64> times;
+        QElapsedTimer total;
+        total.start();
+        while (times.size() < MAX_ITERATIONS &&
+               (times.size() < MIN_ITERATIONS ||
+                total.elapsed() < MIN_TIME_MS)) {
+            QElapsedTimer timer;
+            timer.start();
+            body();
+            times << timer.nsecsElapsed();
+        }
+        std::sort(times.begin(), times.end());
+        qint64 sum = 0;
+        for (qint64 t : times) {
+            sum += t;
+        }
+
+        QJsonObject result;
+        result["name"] = name;
+        result["iterations"] = times.size();
+        result["min_ns"] = times.first();
+        result["median_ns"] = times.at(times.size() / 2);
+        result["mean_ns"] = sum / times.size();
+        m_results.append(result);
+        QTextStream(stderr) << name << ": " << times.at(times.size() / 2)
+                            << " ns\n";
+    }
+
+    QJsonArray results() const { return m_results; }
+
+private:
+    QString m_filter;
+    QJsonArray m_results;
+};
+
+QPixmap testScreenshot(const QSize& size)
+{
+    // a gradient so that the encoders have some work to do
+    QImage image(size, QImage::Format_RGB32);
+    for (int y = 0; y < image.height(); ++y) {
+        auto* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+        for (int x = 0; x < image.width(); ++x) {
+            line[x] = qRgb(x % 256, y % 256, (x * y) % 256);
+        }
+    }
+    return QPixmap::fromImage(image);
+}
+
+// A tool object as if it had been drawn from `from` to `to`
+CaptureTool* createTool(CaptureTool::Type type,
+                        const QPoint& from,
+                        const QPoint& to,
+                        QObject* parent)
+{
+    CaptureTool* tool = ToolFactory().CreateTool(type, parent);
+    CaptureContext context;
+    context.color = Qt::red;
+    context.toolSize = 4;
+    context.circleCount = 1;
+    context.mousePos = from;
+    tool->drawStart(context);
+    // path tools need the intermediate points
+    const int steps = 8;
+    for (int i = 1; i <= steps; ++i) {
+        tool->drawMove(from + (to - from) * i / steps);
+    }
+    tool->drawEnd(to);
+    return tool;
+}
+
+const QVector<CaptureTool::Type> DRAWING_TOOLS{
+    CaptureTool::TYPE_PENCIL,    CaptureTool::TYPE_DRAWER,
+    CaptureTool::TYPE_ARROW,     CaptureTool::TYPE_SELECTION,
+    CaptureTool::TYPE_RECTANGLE, CaptureTool::TYPE_CIRCLE,
+    CaptureTool::TYPE_MARKER,    CaptureTool::TYPE_PIXELATE,
+    CaptureTool::TYPE_CIRCLECOUNT, CaptureTool::TYPE_INVERT,
+};
+
+QVector<CaptureTool*> randomTools(int count, const QSize& area, QObject* parent)
+{
+    QRandomGenerator random(count);
+    QVector<CaptureTool*> tools;
+    for (int i = 0; i < count; ++i) {
+        QPoint from(random.bounded(area.width()),
+                    random.bounded(area.height()));
+        QPoint to = from + QPoint(random.bounded(-200, 200),
+                                  random.bounded(-200, 200));
+        tools << createTool(
+          DRAWING_TOOLS.at(i % DRAWING_TOOLS.size()), from, to, parent);
+    }
+    return tools;
+}
+
+void benchDrawToolsData(Bench& bench)
+{
+    // Same work as CaptureWidget::drawToolsData, without the widget
+    for (int count : { 10, 100, 500 }) {
+        QObject parent;
+        QList<QPointer<CaptureTool>> objects;
+        for (CaptureTool* tool : randomTools(count, CAPTURE_SIZE, &parent)) {
+            objects << tool;
+        }
+        QPixmap screenshot = testScreenshot(CAPTURE_SIZE);
+        ImageTileStore origTiles;
+        origTiles.reset(screenshot);
+        bench.run(QStringLiteral("drawToolsData/%1").arg(count), [&]() {
+            ExportRenderer::replay(screenshot, origTiles, objects);
+        });
+    }
+}
+
+void benchFind(Bench& bench)
+{
+    const QSize size(800, 600);
+    for (int count : { 10, 50 }) {
+        QObject parent;
+        CaptureToolObjects objects;
+        for (CaptureTool* tool : randomTools(count, size, &parent)) {
+            objects.append(tool);
+        }
+        QRandomGenerator random(count);
+        bench.run(QStringLiteral("CaptureToolObjects::find/%1").arg(count),
+                  [&]() {
+                      QPoint pos(random.bounded(size.width()),
+                                 random.bounded(size.height()));
+                      objects.find(pos, size);
+                  });
+    }
+}
+
+void benchProcess(Bench& bench)
+{
+    QPixmap screenshot = testScreenshot(CAPTURE_SIZE);
+    for (CaptureTool::Type type : DRAWING_TOOLS) {
+        QObject parent;
+        CaptureTool* tool =
+          createTool(type, QPoint(400, 300), QPoint(800, 600), &parent);
+        bench.run(QStringLiteral("process/") + tool->name(), [&]() {
+            QPainter painter(&screenshot);
+            painter.setRenderHint(QPainter::Antialiasing);
+            tool->process(painter, screenshot);
+        });
+    }
+}
+
+void benchPixelate(Bench& bench)
+{
+    QPixmap screenshot = testScreenshot(CAPTURE_SIZE);
+    for (int side : { 64, 256, 1024 }) {
+        QObject parent;
+        CaptureTool* tool = createTool(CaptureTool::TYPE_PIXELATE,
+                                       QPoint(10, 10),
+                                       QPoint(10 + side, 10 + side),
+                                       &parent);
+        bench.run(QStringLiteral("pixelate/%1x%1").arg(side), [&]() {
+            QPainter painter(&screenshot);
+            tool->process(painter, screenshot);
+        });
+    }
+}
+
+void benchSave(Bench& bench, const QString& directory)
+{
+    QPixmap screenshot = testScreenshot(CAPTURE_SIZE);
+    for (const QString& format : QStringList{ "png", "jpg", "bmp" }) {
+        ConfigHandler().setSaveAsFileExtension(format);
+        QDir dir(directory + "/save-" + format);
+        dir.mkpath(".");
+        bench.run(QStringLiteral("saveToFilesystem/") + format, [&]() {
+            saveToFilesystem(screenshot, dir.filePath("capture." + format));
+        });
+        dir.removeRecursively();
+    }
+    ConfigHandler().setSaveAsFileExtension(QString());
+}
+
+void benchHistory(Bench& bench)
+{
+    QPixmap screenshot = testScreenshot(CAPTURE_SIZE);
+    History history;
+    int i = 0;
+    bench.run(QStringLiteral("History::save"), [&]() {
+        history.save(screenshot,
+                     history.packFileName(
+                       "bench", "token", QString::number(i++) + ".png"));
+    });
+    bench.run(QStringLiteral("History::history"), [&]() { history.history(); });
+}
+
+void benchConfig(Bench& bench)
+{
+    bench.run(QStringLiteral("ConfigHandler::value"), []() {
+        ConfigHandler().value(QStringLiteral("drawColor"));
+    });
+}
+
+void benchPinHandoff(Bench& bench)
+{
+    // Serialization done by FlameshotDaemon::createPin and attachPin when the
+    // pin is handed to the daemon over D-Bus
+    QPixmap screenshot = testScreenshot(QSize(800, 600));
+    QRect geometry(100, 100, 800, 600);
+    bench.run(QStringLiteral("pinHandoff"), [&]() {
+        QByteArray data;
+        QDataStream out(&data, QIODevice::WriteOnly);
+        out << screenshot << geometry;
+        QDBusMessage m = QDBusMessage::createMethodCall(
+          QStringLiteral("org.flameshot.Flameshot"),
+          QStringLiteral("/"),
+          QLatin1String(""),
+          QStringLiteral("attachPin"));
+        m << data;
+
+        QDataStream in(m.arguments().first().toByteArray());
+        QPixmap pixmap;
+        QRect rect;
+        in >> pixmap >> rect;
+    });
+}
+}
+
+int main(int argc, char* argv[])
+{
+    // Keep the configuration, history and logs of the user out of reach
+    QTemporaryDir home;
+    qputenv("HOME", home.path().toLocal8Bit());
+    qputenv("XDG_CONFIG_HOME", (home.path() + "/config").toLocal8Bit());
+    qputenv("XDG_CACHE_HOME", (home.path() + "/cache").toLocal8Bit());
+    qputenv("XDG_STATE_HOME", (home.path() + "/state").toLocal8Bit());
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    QApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("flameshot"));
+    QCoreApplication::setOrganizationName(QStringLiteral("flameshot"));
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption filterOption(
+      "filter", "Only run the benchmarks containing <text>.", "text");
+    QCommandLineOption outputOption(
+      "output", "Write the JSON results to <file>.", "file");
+    parser.addOption(filterOption);
+    parser.addOption(outputOption);
+    parser.process(app);
+
+    ConfigHandler().setShowDesktopNotification(false);
+
+    Bench bench(parser.value(filterOption));
+    benchDrawToolsData(bench);
+    benchFind(bench);
+    benchProcess(bench);
+    benchPixelate(bench);
+    benchSave(bench, home.path());
+    benchHistory(bench);
+    benchConfig(bench);
+    benchPinHandoff(bench);
+
+    QJsonObject report;
+    report["qt"] = QString::fromLatin1(qVersion());
+    report["platform"] = QGuiApplication::platformName();
+    report["benchmarks"] = bench.results();
+    QByteArray json = QJsonDocument(report).toJson();
+
+    if (parser.isSet(outputOption)) {
+        QFile file(parser.value(outputOption));
+        if (!file.open(QIODevice::WriteOnly) || file.write(json) < 0) {
+            QTextStream(stderr) << "Unable to write " << file.fileName()
+                                << "\n";
+            return 1;
+        }
+    } else {
+        QTextStream(stdout) << json;
+    }
+    return 0;
+}
@@ -0,0 +1,188 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "src/tools/capturecontext.h"
+#include "src/tools/capturetool.h"
+#include "src/tools/toolfactory.h"
+#include "src/utils/imagetilestore.h"
+#include "src/widgets/capture/exportrenderer.h"
+#include <QPainter>
+#include <QStandardPaths>
+#include <QtTest>
+
+class TestExportRenderer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void render_data();
+    void render();
+    void renderFallsBack();
+    void replayRestoresOriginal();
+
+private:
+    CaptureTool* createTool(CaptureTool::Type type,
+                            const QPoint& from,
+                            const QPoint& to);
+    CaptureTool* createText(const QString& text, const QPoint& pos);
+    QList<QPointer<CaptureTool>> boundedObjects();
+    QList<QPointer<CaptureTool>> mixedObjects();
+    static QPixmap screenshot(qreal devicePixelRatio);
+    static QImage toImage(const QPixmap& pixmap);
+
+    QObject m_parent;
+};
+
+void TestExportRenderer::initTestCase()
+{
+    // the tools read the user configuration
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+void TestExportRenderer::render_data()
+{
+    QTest::addColumn<bool>("mixed");
+    QTest::addColumn<qreal>("ratio");
+    QTest::addColumn<QRect>("selection");
+
+    QTest::newRow("bounded") << false << 1.0 << QRect();
+    QTest::newRow("bounded, selection")
+      << false << 1.0 << QRect(100, 80, 300, 250);
+    QTest::newRow("bounded, hidpi") << false << 2.0 << QRect();
+    QTest::newRow("mixed") << true << 1.0 << QRect();
+    QTest::newRow("mixed, selection")
+      << true << 1.0 << QRect(100, 80, 300, 250);
+    QTest::newRow("mixed, hidpi") << true << 2.0 << QRect(60, 40, 500, 400);
+}
+
+// The parallel rendering must give the same pixels as the screenshot of the
+// editor, on which CaptureWidget::drawToolsData() replays the objects
+void TestExportRenderer::render()
+{
+    QFETCH(bool, mixed);
+    QFETCH(qreal, ratio);
+    QFETCH(QRect, selection);
+
+    QList<QPointer<CaptureTool>> objects =
+      mixed ? mixedObjects() : boundedObjects();
+    QPixmap working = screenshot(ratio);
+    ImageTileStore origTiles;
+    origTiles.reset(working);
+    ExportRenderer::replay(working, origTiles, objects);
+
+    QPixmap rendered =
+      ExportRenderer(working, origTiles, objects).render(selection);
+    QVERIFY(!rendered.isNull());
+    QCOMPARE(rendered.devicePixelRatio(), ratio);
+    QRect area = selection.isNull() ? working.rect() : selection;
+    QCOMPARE(toImage(rendered), toImage(working.copy(area)));
+}
+
+// A tool reading pixels past the screen leaves the export to the editor
+void TestExportRenderer::renderFallsBack()
+{
+    QList<QPointer<CaptureTool>> objects = boundedObjects();
+    objects << createTool(
+      CaptureTool::TYPE_PIXELATE, { 600, 440 }, { 700, 520 });
+    QPixmap working = screenshot(1);
+    ImageTileStore origTiles;
+    origTiles.reset(working);
+    ExportRenderer::replay(working, origTiles, objects);
+
+    QVERIFY(ExportRenderer(working, origTiles, objects).render({}).isNull());
+}
+
+// Removing the objects has to revert every pixel they painted, even past
+// their bounding rect
+void TestExportRenderer::replayRestoresOriginal()
+{
+    QPixmap original = screenshot(1);
+    QImage expected = toImage(original);
+    QPixmap working = original;
+    ImageTileStore origTiles;
+    origTiles.reset(working);
+
+    ExportRenderer::replay(working, origTiles, mixedObjects());
+    QVERIFY(toImage(working) != expected);
+    ExportRenderer::replay(working, origTiles, {});
+    QCOMPARE(toImage(working), expected);
+}
+
+CaptureTool* TestExportRenderer::createTool(CaptureTool::Type type,
+                                            const QPoint& from,
+                                            const QPoint& to)
+{
+    CaptureTool* tool = ToolFactory().CreateTool(type, &m_parent);
+    CaptureContext context;
+    context.color = Qt::red;
+    context.toolSize = 12;
+    context.circleCount = 1;
+    context.mousePos = from;
+    tool->drawStart(context);
+    const int steps = 8;
+    for (int i = 1; i <= steps; ++i) {
+        tool->drawMove(from + (to - from) * i / steps);
+    }
+    tool->drawEnd(to);
+    return tool;
+}
+
+CaptureTool* TestExportRenderer::createText(const QString& text,
+                                            const QPoint& pos)
+{
+    CaptureTool* tool = ToolFactory().CreateTool(CaptureTool::TYPE_TEXT,
+                                                 &m_parent);
+    tool->onColorChanged(Qt::blue);
+    tool->onSizeChanged(24);
+    // the text is normally typed in the editor widget of the tool
+    QMetaObject::invokeMethod(tool, "updateText", Q_ARG(QString, text));
+    tool->move(pos);
+    return tool;
+}
+
+QList<QPointer<CaptureTool>> TestExportRenderer::boundedObjects()
+{
+    return {
+        createTool(CaptureTool::TYPE_SELECTION, { 20, 20 }, { 150, 120 }),
+        createTool(CaptureTool::TYPE_CIRCLE, { 140, 100 }, { 260, 200 }),
+        createTool(CaptureTool::TYPE_PIXELATE, { 400, 300 }, { 520, 380 }),
+        createTool(CaptureTool::TYPE_INVERT, { 480, 40 }, { 600, 160 }),
+        // reads the pixels painted by the circle
+        createTool(CaptureTool::TYPE_PIXELATE, { 200, 150 }, { 300, 260 }),
+    };
+}
+
+QList<QPointer<CaptureTool>> TestExportRenderer::mixedObjects()
+{
+    return {
+        createTool(CaptureTool::TYPE_ARROW, { 30, 400 }, { 250, 300 }),
+        createTool(CaptureTool::TYPE_MARKER, { 300, 60 }, { 560, 90 }),
+        createTool(CaptureTool::TYPE_RECTANGLE, { 350, 200 }, { 450, 260 }),
+        createText(QStringLiteral("Flameshot\nexport"), { 80, 180 }),
+        createTool(CaptureTool::TYPE_PIXELATE, { 60, 170 }, { 200, 260 }),
+        createTool(CaptureTool::TYPE_INVERT, { 500, 350 }, { 620, 460 }),
+    };
+}
+
+QPixmap TestExportRenderer::screenshot(qreal devicePixelRatio)
+{
+    QImage image(QSize(640, 480) * devicePixelRatio, QImage::Format_RGB32);
+    for (int y = 0; y < image.height(); ++y) {
+        auto* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+        for (int x = 0; x < image.width(); ++x) {
+            line[x] = qRgb(x % 256, y % 256, (x * y) % 256);
+        }
+    }
+    QPixmap pixmap = QPixmap::fromImage(image);
+    pixmap.setDevicePixelRatio(devicePixelRatio);
+    return pixmap;
+}
+
+QImage TestExportRenderer::toImage(const QPixmap& pixmap)
+{
+    return pixmap.toImage().convertToFormat(QImage::Format_ARGB32);
+}
+
+QTEST_MAIN(TestExportRenderer)
+#include "tst_exportrenderer.moc"
@@ -0,0 +1,115 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "src/core/flameshotdbusadapter.h"
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDBusPendingCall>
+#include <QDBusPendingReply>
+#include <QDBusUnixFileDescriptor>
+#include <QRect>
+#include <QStandardPaths>
+#include <QtTest>
+
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+
+// The adaptor is exported on the session bus like in main.cpp and called
+// from a second connection, so the calls go through the bus daemon
+class TestFlameshotDBusAdapter : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void captureToFdErrors_data();
+    void captureToFdErrors();
+
+private:
+    QDBusPendingCall call(const QString& method, const QVariantList& args);
+
+    QObject m_exported;
+    int m_pipe[2] = { -1, -1 };
+};
+
+void TestFlameshotDBusAdapter::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    if (!QDBusConnection::sessionBus().isConnected()) {
+        QSKIP("No D-Bus session bus");
+    }
+    if (!QDBusConnection::sessionBus().connectionCapabilities().testFlag(
+          QDBusConnection::UnixFileDescriptorPassing)) {
+        QSKIP("The session bus can't pass file descriptors");
+    }
+#ifdef Q_OS_UNIX
+    QVERIFY(::pipe(m_pipe) == 0);
+#endif
+    new FlameshotDBusAdapter(&m_exported);
+    QVERIFY(QDBusConnection::sessionBus().registerObject(
+      QStringLiteral("/"), &m_exported));
+}
+
+void TestFlameshotDBusAdapter::cleanupTestCase()
+{
+    QDBusConnection::sessionBus().unregisterObject(QStringLiteral("/"));
+    QDBusConnection::disconnectFromBus(QStringLiteral("client"));
+#ifdef Q_OS_UNIX
+    for (int fd : m_pipe) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+#endif
+}
+
+void TestFlameshotDBusAdapter::captureToFdErrors_data()
+{
+    QTest::addColumn<int>("screen");
+    QTest::addColumn<QString>("format");
+
+    QTest::newRow("unsupported format") << -1 << QStringLiteral("nope");
+    QTest::newRow("screen out of range") << 1000 << QStringLiteral("png");
+}
+
+// An invalid call gets an error reply and the adaptor keeps answering
+void TestFlameshotDBusAdapter::captureToFdErrors()
+{
+    QFETCH(int, screen);
+    QFETCH(QString, format);
+
+    QDBusPendingCall pending =
+      call(QStringLiteral("captureToFd"),
+           { QVariant::fromValue(QDBusUnixFileDescriptor(m_pipe[1])),
+             QRect(),
+             screen,
+             format });
+    QTRY_VERIFY(pending.isFinished());
+    QVERIFY(pending.isError());
+    QCOMPARE(pending.error().type(), QDBusError::InvalidArgs);
+
+    QDBusPendingReply<QString> metrics =
+      call(QStringLiteral("getMetrics"), {});
+    QTRY_VERIFY(metrics.isFinished());
+    QVERIFY2(metrics.isValid(), qPrintable(metrics.error().message()));
+}
+
+QDBusPendingCall TestFlameshotDBusAdapter::call(const QString& method,
+                                                const QVariantList& args)
+{
+    QDBusConnection client = QDBusConnection::connectToBus(
+      QDBusConnection::SessionBus, QStringLiteral("client"));
+    QString service = QDBusConnection::sessionBus().baseService();
+    QDBusMessage m =
+      QDBusMessage::createMethodCall(service,
+                                     QStringLiteral("/"),
+                                     QStringLiteral("org.flameshot.Flameshot"),
+                                     method);
+    m.setArguments(args);
+    return client.asyncCall(m);
+}
+
+QTEST_MAIN(TestFlameshotDBusAdapter)
+#include "tst_flameshotdbusadapter.moc"
@@ -0,0 +1,193 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "src/utils/scrollstitcher.h"
+#include <QPainter>
+#include <QtTest>
+
+// The frames are cut from a synthetic page whose rows are all different,
+// except for the blank lines when asked for
+class TestScrollStitcher : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void rowHashes();
+    void findOffset_data();
+    void findOffset();
+    void findOffsetUnchanged();
+    void findOffsetNotAligned();
+    void stitchStickyHeaderAndFooter();
+    void addFrameNotAligned();
+
+private:
+    static QImage page(int height, bool blankLines);
+    static QImage frame(const QImage& page, int scroll, int header, int footer);
+
+    static constexpr int WIDTH = 240;
+    static constexpr int HEIGHT = 200;
+};
+
+QImage TestScrollStitcher::page(int height, bool blankLines)
+{
+    QImage image(WIDTH, height, QImage::Format_RGB32);
+    for (int y = 0; y < height; ++y) {
+        auto* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+        // lines of text of 4 rows separated by 6 blank rows
+        const bool blank = blankLines && y % 10 >= 4;
+        for (int x = 0; x < WIDTH; ++x) {
+            line[x] = blank ? qRgb(255, 255, 255)
+                            : qRgb(y & 0xff, (y >> 8) & 0xff, x & 0xff);
+        }
+    }
+    return image;
+}
+
+// The viewport of `page` scrolled by `scroll` rows, with `header` and
+// `footer` rows that don't scroll
+QImage TestScrollStitcher::frame(const QImage& page,
+                                 int scroll,
+                                 int header,
+                                 int footer)
+{
+    QImage image(WIDTH, HEIGHT, QImage::Format_RGB32);
+    image.fill(QColor(40, 90, 160));
+    QPainter painter(&image);
+    painter.drawImage(QPoint(0, header),
+                      page,
+                      QRect(0, scroll, WIDTH, HEIGHT - header - footer));
+    // the header and footer have rows of their own so they are told apart
+    for (int y = 0; y < header; ++y) {
+        painter.fillRect(0, y, WIDTH, 1, QColor(200, y, 0));
+    }
+    for (int y = HEIGHT - footer; y < HEIGHT; ++y) {
+        painter.fillRect(0, y, WIDTH, 1, QColor(0, y % 256, 200));
+    }
+    painter.end();
+    return image;
+}
+
+void TestScrollStitcher::rowHashes()
+{
+    QImage image = page(HEIGHT, false);
+    QVector<uint> hashes = ScrollStitcher::rowHashes(image);
+    QCOMPARE(hashes.size(), HEIGHT);
+    QVERIFY(hashes[0] != hashes[1]);
+
+    // the scroll bar at the right edge is left out
+    QImage withScrollBar = image;
+    QPainter painter(&withScrollBar);
+    painter.fillRect(WIDTH - 10, 0, 10, HEIGHT, Qt::gray);
+    painter.end();
+    QCOMPARE(ScrollStitcher::rowHashes(withScrollBar), hashes);
+}
+
+void TestScrollStitcher::findOffset_data()
+{
+    QTest::addColumn<bool>("blankLines");
+    QTest::addColumn<int>("header");
+    QTest::addColumn<int>("footer");
+    QTest::addColumn<int>("offset");
+
+    QTest::newRow("shifted") << false << 0 << 0 << 37;
+    QTest::newRow("one row") << false << 0 << 0 << 1;
+    QTest::newRow("most of the frame") << false << 0 << 0 << 170;
+    QTest::newRow("sticky header and footer") << false << 30 << 20 << 25;
+    QTest::newRow("blank lines") << true << 0 << 0 << 43;
+    QTest::newRow("blank lines, sticky header") << true << 24 << 0 << 60;
+}
+
+void TestScrollStitcher::findOffset()
+{
+    QFETCH(bool, blankLines);
+    QFETCH(int, header);
+    QFETCH(int, footer);
+    QFETCH(int, offset);
+
+    QImage content = page(1000, blankLines);
+    QVector<uint> previous =
+      ScrollStitcher::rowHashes(frame(content, 100, header, footer));
+    QVector<uint> current =
+      ScrollStitcher::rowHashes(frame(content, 100 + offset, header, footer));
+    QCOMPARE(ScrollStitcher::findOffset(previous, current), offset);
+}
+
+void TestScrollStitcher::findOffsetUnchanged()
+{
+    QVector<uint> hashes =
+      ScrollStitcher::rowHashes(frame(page(1000, true), 50, 10, 10));
+    QCOMPARE(ScrollStitcher::findOffset(hashes, hashes), 0);
+}
+
+void TestScrollStitcher::findOffsetNotAligned()
+{
+    QImage content = page(1000, false);
+    auto hashesAt = [&content](int scroll) {
+        return ScrollStitcher::rowHashes(frame(content, scroll, 0, 0));
+    };
+    QVector<uint> previous = hashesAt(100);
+
+    // scrolled up
+    QCOMPARE(ScrollStitcher::findOffset(previous, hashesAt(60)), -1);
+    // scrolled further than a frame
+    QCOMPARE(ScrollStitcher::findOffset(previous, hashesAt(400)), -1);
+    // too few rows in common
+    QCOMPARE(ScrollStitcher::findOffset(previous, hashesAt(100 + HEIGHT - 8)),
+             -1);
+    // frames of different sizes
+    QCOMPARE(ScrollStitcher::findOffset(previous, previous.mid(1)), -1);
+}
+
+// Every scrolled row is kept once, the header and the footer only once
+void TestScrollStitcher::stitchStickyHeaderAndFooter()
+{
+    const int header = 30, footer = 20;
+    QImage content = page(1000, true);
+    ScrollStitcher stitcher;
+    int scroll = 0;
+    for (int step : { 0, 40, 40, 0, 73, 95, 5 }) {
+        scroll += step;
+        ScrollStitcher::FrameResult expected =
+          step == 0 && scroll > 0 ? ScrollStitcher::FRAME_UNCHANGED
+                                  : ScrollStitcher::FRAME_STITCHED;
+        QCOMPARE(stitcher.addFrame(frame(content, scroll, header, footer)),
+                 expected);
+    }
+
+    const int viewport = HEIGHT - header - footer;
+    QImage expected(
+      WIDTH, header + scroll + viewport + footer, QImage::Format_RGB32);
+    QPainter painter(&expected);
+    QImage last = frame(content, scroll, header, footer);
+    painter.drawImage(QPoint(0, 0), last, QRect(0, 0, WIDTH, header));
+    painter.drawImage(QPoint(0, header),
+                      content,
+                      QRect(0, 0, WIDTH, scroll + viewport));
+    painter.drawImage(QPoint(0, header + scroll + viewport),
+                      last,
+                      QRect(0, HEIGHT - footer, WIDTH, footer));
+    painter.end();
+
+    QCOMPARE(stitcher.height(), expected.height());
+    QCOMPARE(stitcher.result(), expected);
+}
+
+void TestScrollStitcher::addFrameNotAligned()
+{
+    QImage content = page(1000, false);
+    ScrollStitcher stitcher;
+    QCOMPARE(stitcher.addFrame(frame(content, 200, 0, 0)),
+             ScrollStitcher::FRAME_STITCHED);
+    QCOMPARE(stitcher.addFrame(frame(content, 150, 0, 0)),
+             ScrollStitcher::FRAME_NOT_ALIGNED);
+    QImage cropped = frame(content, 200, 0, 0).copy(0, 0, WIDTH, 100);
+    QCOMPARE(stitcher.addFrame(cropped), ScrollStitcher::FRAME_NOT_ALIGNED);
+    // the frames not aligned are dropped
+    QCOMPARE(stitcher.height(), HEIGHT);
+    QCOMPARE(stitcher.addFrame(frame(content, 260, 0, 0)),
+             ScrollStitcher::FRAME_STITCHED);
+    QCOMPARE(stitcher.height(), HEIGHT + 60);
+}
+
+QTEST_MAIN(TestScrollStitcher)
+#include "tst_scrollstitcher.moc"
@@ -0,0 +1,208 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2017-2019 Alejandro Sirgo Rica & Contributors
+
+#include "src/tools/imgupload/uploadqueue.h"
+#include <QNetworkReply>
+#include <QPointer>
+#include <QStandardPaths>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QtTest>
+
+// Minimal HTTP server answering the uploads with the queued status codes,
+// 200 once there are none left. While held, the requests are only counted
+// and answered on release().
+class UploadServer : public QTcpServer
+{
+    Q_OBJECT
+public:
+    explicit UploadServer(QObject* parent = nullptr)
+      : QTcpServer(parent)
+    {
+        connect(this, &QTcpServer::newConnection, this, [this]() {
+            while (QTcpSocket* socket = nextPendingConnection()) {
+                connect(socket, &QTcpSocket::readyRead, this, [this, socket]() {
+                    read(socket);
+                });
+                connect(socket,
+                        &QTcpSocket::disconnected,
+                        this,
+                        [this, socket]() {
+                            m_buffers.remove(socket);
+                            socket->deleteLater();
+                        });
+            }
+        });
+    }
+
+    QUrl url() const
+    {
+        return QUrl(QStringLiteral("http://127.0.0.1:%1/upload")
+                      .arg(serverPort()));
+    }
+
+    void release()
+    {
+        hold = false;
+        for (const QPointer<QTcpSocket>& socket : m_held) {
+            if (socket) {
+                answer(socket);
+            }
+        }
+        m_held.clear();
+    }
+
+    QList<int> statuses;
+    bool hold = false;
+    int received = 0;
+
+private:
+    void read(QTcpSocket* socket)
+    {
+        QByteArray& buffer = m_buffers[socket];
+        buffer += socket->readAll();
+        while (true) {
+            int headerEnd = buffer.indexOf("\r\n\r\n");
+            if (headerEnd < 0) {
+                return;
+            }
+            int length = 0;
+            for (const QByteArray& line :
+                 buffer.left(headerEnd).split('\n')) {
+                if (line.toLower().startsWith("content-length:")) {
+                    length = line.mid(15).trimmed().toInt();
+                }
+            }
+            int requestSize = headerEnd + 4 + length;
+            if (buffer.size() < requestSize) {
+                return;
+            }
+            buffer.remove(0, requestSize);
+            ++received;
+            if (hold) {
+                m_held << socket;
+            } else {
+                answer(socket);
+            }
+        }
+    }
+
+    void answer(QTcpSocket* socket)
+    {
+        int status = statuses.isEmpty() ? 200 : statuses.takeFirst();
+        socket->write(QStringLiteral("HTTP/1.1 %1 Status\r\n"
+                                     "Content-Length: 2\r\n"
+                                     "Connection: keep-alive\r\n\r\nok")
+                        .arg(status)
+                        .toLatin1());
+    }
+
+    QHash<QTcpSocket*, QByteArray> m_buffers;
+    QList<QPointer<QTcpSocket>> m_held;
+};
+
+class TestUploadQueue : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+    void cleanup();
+    void retriesTransientErrors();
+    void cancelDuringRetryDelay();
+    void limitsRunningUploads();
+
+private:
+    UploadTask* enqueue();
+
+    UploadServer* m_server = nullptr;
+};
+
+void TestUploadQueue::initTestCase()
+{
+    // the encoder reads the user configuration
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+void TestUploadQueue::init()
+{
+    m_server = new UploadServer(this);
+    QVERIFY(m_server->listen(QHostAddress::LocalHost));
+}
+
+void TestUploadQueue::cleanup()
+{
+    delete m_server;
+    m_server = nullptr;
+}
+
+void TestUploadQueue::retriesTransientErrors()
+{
+    m_server->statuses = { 503 };
+    UploadTask* task = enqueue();
+    QSignalSpy retrying(task, &UploadTask::retrying);
+    int status = 0;
+    connect(task, &UploadTask::finished, this, [&status](QNetworkReply* r) {
+        status = r->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    });
+
+    QTRY_COMPARE_WITH_TIMEOUT(status, 200, 10000);
+    QCOMPARE(retrying.count(), 1);
+    QCOMPARE(retrying.at(0).at(0).toInt(), 1);
+    QCOMPARE(retrying.at(0).at(1).toInt(), UploadQueue::RETRY_DELAY_MS);
+    QCOMPARE(m_server->received, 2);
+}
+
+// A task cancelled while waiting for its next attempt makes no more
+// requests, emits nothing and gives its place to the next upload
+void TestUploadQueue::cancelDuringRetryDelay()
+{
+    m_server->statuses = { 503 };
+    QPointer<UploadTask> task = enqueue();
+    QSignalSpy finished(task.data(), &UploadTask::finished);
+    connect(task.data(), &UploadTask::retrying, task, &UploadTask::cancel);
+
+    QTRY_VERIFY_WITH_TIMEOUT(task.isNull(), 10000);
+    QCOMPARE(finished.count(), 0);
+    QCOMPARE(m_server->received, 1);
+
+    UploadTask* next = enqueue();
+    QSignalSpy nextFinished(next, &UploadTask::finished);
+    QTRY_COMPARE_WITH_TIMEOUT(nextFinished.count(), 1, 10000);
+    QCOMPARE(m_server->received, 2);
+}
+
+void TestUploadQueue::limitsRunningUploads()
+{
+    const int count = UploadQueue::MAX_RUNNING + 2;
+    m_server->hold = true;
+    int finished = 0;
+    for (int i = 0; i < count; ++i) {
+        connect(enqueue(), &UploadTask::finished, this, [&finished]() {
+            ++finished;
+        });
+    }
+
+    QTRY_COMPARE_WITH_TIMEOUT(
+      m_server->received, UploadQueue::MAX_RUNNING, 10000);
+    // the other uploads wait for a running one to finish
+    QTest::qWait(500);
+    QCOMPARE(m_server->received, UploadQueue::MAX_RUNNING);
+    QCOMPARE(finished, 0);
+
+    m_server->release();
+    QTRY_COMPARE_WITH_TIMEOUT(finished, count, 10000);
+    QCOMPARE(m_server->received, count);
+}
+
+UploadTask* TestUploadQueue::enqueue()
+{
+    QImage image(64, 48, QImage::Format_RGB32);
+    image.fill(Qt::darkCyan);
+    return UploadQueue::instance()->enqueue(
+      QNetworkRequest(m_server->url()), QStringLiteral("image"), image);
+}
+
+QTEST_MAIN(TestUploadQueue)
+#include "tst_uploadqueue.moc"